@@ -14,6 +14,10 @@
 #include "../olap/parallel_operations.h"
 #include "../olap/omp_operations.h"
 
+#include "layout_benchmarks.h"
+#include "pool_benchmarks.h"
+#include "reduce_benchmarks.h"
+
 
 namespace benchmark {
 
@@ -158,5 +162,15 @@ inline void run_benchmark_generic(size_t T, size_t LAT, size_t LON)
 
     std::cout << "\nBenchmark finished.\n";
     std::cout << "Runs per operation: " << RUNS << "\n";
+
+    run_layout_comparison(omp_cube);
+
+    // The cubes above are all zero; sparse cost and quantization error
+    // depend on the values, so those comparisons need rainfall-like data
+    const auto rainfall = synthetic_rainfall(T, LAT, LON);
+    run_sparse_comparison(rainfall);
+    run_quantized_comparison(rainfall);
+    run_pool_overhead_comparison(omp_cube);
+    run_reduce_fusion_comparison(omp_cube);
 }
 }
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../utils/timer.h"
+#include "../cube/time_axis.h"
+#include "../builder/omp_sc_builder.h"
+#include "../builder/parallel_simple_cube_builder.h"
+
+namespace benchmark {
+
+// Strong-scaling curve of the partitioned OpenMP builder:
+// 1, 2, 4, ... max_threads threads on the same observations.
+inline void run_builder_scaling(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    unsigned int max_threads = 64,
+    const std::string& path = "builder_scaling.csv")
+{
+    std::cout << "\n=== OMP Builder Scaling ===\n";
+
+    const int RUNS = 3;
+
+    std::ofstream file(path);
+    file << "threads,time_seconds,speedup,efficiency\n";
+
+    double base_time = 0.0;
+
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        double best = 0.0;
+
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto t0 = Timer::now();
+            auto cube = OMPSimpleCubeBuilder::build(lat, lon, nsr, hours, axis, threads);
+            auto t1 = Timer::now();
+
+            double elapsed = Timer::elapsed(t0, t1);
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+
+        if (threads == 1)
+            base_time = best;
+
+        double speedup = base_time / best;
+
+        std::cout << "  " << threads << " threads: "
+                  << best << " s  (speedup " << speedup << ")\n";
+
+        file << threads << ","
+             << best << ","
+             << speedup << ","
+             << speedup / threads << "\n";
+    }
+
+    std::cout << "Scaling curve written to " << path << "\n";
+}
+
+// Mutex vs atomic vs privatized accumulation in the std::thread builder
+inline void run_accumulation_comparison(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    unsigned int num_threads = 0,
+    const std::string& path = "accumulation_results.csv")
+{
+    using Mode = ParallelSimpleCubeBuilder::Accumulation;
+
+    std::cout << "\n=== Thread Builder Accumulation ===\n";
+
+    const int RUNS = 3;
+    const Mode modes[] = {Mode::Mutex, Mode::Atomic, Mode::Privatized};
+
+    std::ofstream file(path);
+    file << "mode,time_seconds,speedup_vs_mutex\n";
+
+    double mutex_time = 0.0;
+
+    for (Mode mode : modes)
+    {
+        double best = 0.0;
+
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto t0 = Timer::now();
+            auto cube = ParallelSimpleCubeBuilder::build(
+                lat, lon, nsr, hours, axis, num_threads, mode);
+            auto t1 = Timer::now();
+
+            double elapsed = Timer::elapsed(t0, t1);
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+
+        if (mode == Mode::Mutex)
+            mutex_time = best;
+
+        const char* name = ParallelSimpleCubeBuilder::accumulation_name(mode);
+
+        std::cout << "  " << name << ": " << best << " s  (speedup "
+                  << mutex_time / best << ")\n";
+
+        file << name << ","
+             << best << ","
+             << mutex_time / best << "\n";
+    }
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+// OMP builder producing the mean cube alone vs the mean plus every
+// measure (sum, count, min, max, M2) in the same scatter pass
+inline void run_measure_overhead(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    const std::string& path = "measure_results.csv")
+{
+    std::cout << "\n=== OMP Builder Measures ===\n";
+
+    const int RUNS = 3;
+
+    auto best_of = [&](auto&& fn) {
+        double best = 0.0;
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto t0 = Timer::now();
+            fn();
+            double elapsed = Timer::elapsed(t0, Timer::now());
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    };
+
+    const double mean_only = best_of([&] {
+        OMPSimpleCubeBuilder::build(lat, lon, nsr, hours, axis);
+    });
+    const double all = best_of([&] {
+        MeasureCube measures(measure::all);
+        OMPSimpleCubeBuilder::build(lat, lon, nsr, hours, axis,
+                                    0, nullptr, nullptr, &measures);
+    });
+
+    std::cout << "  mean only:           " << mean_only << " s\n";
+    std::cout << "  mean + all measures: " << all << " s  ("
+              << all / mean_only << "x)\n";
+
+    std::ofstream file(path);
+    file << "measures,time_seconds\n";
+    file << "mean," << mean_only << "\n";
+    file << "all," << all << "\n";
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+}
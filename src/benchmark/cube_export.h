@@ -1,11 +1,13 @@
 #pragma once
 #include "../cube/simple_cube.h"
+#include <string>
 #include <fstream>
 
 namespace benchmark {
 
-template<typename Dtype>
-void export_cube_csv(const SimpleCube<Dtype>& cube,
+// Accepts a SimpleCube or any CubeView of one
+template<typename Cube>
+void export_cube_csv(const Cube& cube,
                      const std::string& path)
 {
     std::ofstream file(path);
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../utils/timer.h"
+#include "../cube/simple_cube.h"
+#include "../cube/tiled_cube.h"
+#include "../cube/sparse_cube.h"
+#include "../cube/quantized_cube.h"
+#include "../olap/omp_operations.h"
+#include "../olap/tiled_operations.h"
+#include "../olap/sparse_operations.h"
+#include "../olap/quantized_operations.h"
+
+namespace benchmark {
+
+// Row-major SimpleCube (omp_olap) vs TiledCube (tiled_olap) on the same
+// data, best of RUNS per operator, printed and written side by side.
+// Row-major slices and dice are views, so they are materialized here to
+// compare the same amount of copying.
+inline void run_layout_comparison(
+    const SimpleCube<float>& cube,
+    TileShape shape = TileShape(),
+    const std::string& path = "layout_results.csv")
+{
+    std::cout << "\n=== Layout: row-major vs tiled "
+              << shape.t << "×" << shape.lat << "×" << shape.lon << " ===\n";
+
+    const int RUNS = 5;
+
+    auto t0 = Timer::now();
+    auto tiled = TiledCube<float>::from_cube(cube, shape);
+    auto t1 = Timer::now();
+    std::cout << "  re-tile: " << Timer::elapsed(t0, t1) << " s\n";
+
+    const size_t T = cube.time_dim();
+    const size_t LAT = cube.lat_dim();
+    const size_t LON = cube.lon_dim();
+
+    const size_t slice_t = T / 2;
+    const size_t t_end = std::min((size_t)10, T);
+
+    auto best_of = [&](auto&& fn) {
+        double best = 0.0;
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto s = Timer::now();
+            fn();
+            double elapsed = Timer::elapsed(s, Timer::now());
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    };
+
+    struct Row { std::string operation; double row_major; double tiled; };
+    std::vector<Row> rows;
+
+    rows.push_back({"slice_time",
+        best_of([&] { omp_olap::slice_time(cube, slice_t).materialize<SimpleCube<float>>(); }),
+        best_of([&] { tiled_olap::slice_time(tiled, slice_t); })});
+
+    rows.push_back({"dice_time",
+        best_of([&] { omp_olap::dice_time(cube, 0, t_end).materialize<SimpleCube<float>>(); }),
+        best_of([&] { tiled_olap::dice_time(tiled, 0, t_end); })});
+
+    rows.push_back({"rollup_time_sum",
+        best_of([&] { omp_olap::rollup_time_sum(cube); }),
+        best_of([&] { tiled_olap::rollup_time_sum(tiled); })});
+
+    rows.push_back({"rollup_time_mean",
+        best_of([&] { omp_olap::rollup_time_mean(cube); }),
+        best_of([&] { tiled_olap::rollup_time_mean(tiled); })});
+
+    rows.push_back({"global_mean",
+        best_of([&] { omp_olap::global_mean(cube); }),
+        best_of([&] { tiled_olap::global_mean(tiled); })});
+
+    rows.push_back({"region_mean",
+        best_of([&] { omp_olap::region_mean(cube, 0, T, LAT / 4, LAT / 2, LON / 4, LON / 2); }),
+        best_of([&] { tiled_olap::region_mean(tiled, 0, T, LAT / 4, LAT / 2, LON / 4, LON / 2); })});
+
+    std::ofstream file(path);
+    file << "operation,row_major_time,tiled_time,speedup_tiled\n";
+
+    std::cout << "  " << std::left << std::setw(18) << "operation"
+              << std::setw(14) << "row-major(s)"
+              << std::setw(14) << "tiled(s)"
+              << "speedup\n";
+
+    for (const auto& r : rows)
+    {
+        std::cout << "  " << std::left << std::setw(18) << r.operation
+                  << std::setw(14) << r.row_major
+                  << std::setw(14) << r.tiled
+                  << r.row_major / r.tiled << "\n";
+
+        file << r.operation << ","
+             << r.row_major << ","
+             << r.tiled << ","
+             << r.row_major / r.tiled << "\n";
+    }
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+
+// Deterministic stand-in for an hourly rainfall cube: about `wet` of the
+// cells hold an exponentially distributed rate (mean 2 mm/h), the rest
+// are zero, so the sparse and quantized layouts see realistic data.
+inline SimpleCube<float> synthetic_rainfall(size_t T, size_t LAT, size_t LON,
+                                            double wet = 0.09)
+{
+    SimpleCube<float> cube(T, LAT, LON);
+    float* data = cube.data();
+
+    for (size_t i = 0; i < cube.size(); i++)
+    {
+        // splitmix64 of the flat index
+        uint64_t h = i + 0x9e3779b97f4a7c15ull;
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        h ^= h >> 31;
+
+        const double u = (h >> 11) * 0x1.0p-53;
+        data[i] = u < wet ? static_cast<float>(-2.0 * std::log(u / wet)) : 0.0f;
+    }
+    return cube;
+}
+
+// Dense SimpleCube (omp_olap) vs SparseCube (sparse_olap) on the same
+// data. Reports density and resident bytes, then best of RUNS per operator.
+inline void run_sparse_comparison(
+    const SimpleCube<float>& cube,
+    const std::string& path = "sparse_results.csv")
+{
+    std::cout << "\n=== Layout: dense vs sparse ===\n";
+
+    const int RUNS = 5;
+
+    auto t0 = Timer::now();
+    auto sparse = SparseCube<float>::from_cube(cube);
+    auto t1 = Timer::now();
+
+    std::cout << "  compress: " << Timer::elapsed(t0, t1) << " s, "
+              << sparse.nnz() << " non-zero cells ("
+              << sparse.density() * 100 << "%), "
+              << sparse.bytes() / (1024.0 * 1024.0) << " MiB vs "
+              << cube.size() * sizeof(float) / (1024.0 * 1024.0) << " MiB dense\n";
+
+    const size_t T = cube.time_dim();
+    const size_t LAT = cube.lat_dim();
+    const size_t LON = cube.lon_dim();
+
+    const size_t slice_t = T / 2;
+
+    auto best_of = [&](auto&& fn) {
+        double best = 0.0;
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto s = Timer::now();
+            fn();
+            double elapsed = Timer::elapsed(s, Timer::now());
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    };
+
+    struct Row { std::string operation; double dense; double sparse; };
+    std::vector<Row> rows;
+
+    rows.push_back({"slice_time",
+        best_of([&] { omp_olap::slice_time(cube, slice_t).materialize<SimpleCube<float>>(); }),
+        best_of([&] { sparse_olap::slice_time(sparse, slice_t); })});
+
+    rows.push_back({"rollup_time_sum",
+        best_of([&] { omp_olap::rollup_time_sum(cube); }),
+        best_of([&] { sparse_olap::rollup_time_sum(sparse); })});
+
+    rows.push_back({"rollup_time_mean",
+        best_of([&] { omp_olap::rollup_time_mean(cube); }),
+        best_of([&] { sparse_olap::rollup_time_mean(sparse); })});
+
+    rows.push_back({"global_mean",
+        best_of([&] { omp_olap::global_mean(cube); }),
+        best_of([&] { sparse_olap::global_mean(sparse); })});
+
+    rows.push_back({"region_mean",
+        best_of([&] { omp_olap::region_mean(cube, 0, T, LAT / 4, LAT / 2, LON / 4, LON / 2); }),
+        best_of([&] { sparse_olap::region_mean(sparse, 0, T, LAT / 4, LAT / 2, LON / 4, LON / 2); })});
+
+    std::ofstream file(path);
+    file << "operation,dense_time,sparse_time,speedup_sparse\n";
+
+    std::cout << "  " << std::left << std::setw(18) << "operation"
+              << std::setw(14) << "dense(s)"
+              << std::setw(14) << "sparse(s)"
+              << "speedup\n";
+
+    for (const auto& r : rows)
+    {
+        std::cout << "  " << std::left << std::setw(18) << r.operation
+                  << std::setw(14) << r.dense
+                  << std::setw(14) << r.sparse
+                  << r.dense / r.sparse << "\n";
+
+        file << r.operation << ","
+             << r.dense << ","
+             << r.sparse << ","
+             << r.dense / r.sparse << "\n";
+    }
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+
+// float32 SimpleCube (omp_olap) vs each 16-bit QuantizedCube format
+// (quant_olap): memory, best of RUNS per operator, and the accuracy lost
+// against the float32 results.
+inline void run_quantized_comparison(
+    const SimpleCube<float>& cube,
+    const std::string& path = "quantized_results.csv")
+{
+    std::cout << "\n=== Storage: float32 vs 16-bit quantized ===\n";
+
+    const int RUNS = 5;
+
+    const size_t T = cube.time_dim();
+    const size_t LAT = cube.lat_dim();
+    const size_t LON = cube.lon_dim();
+
+    auto best_of = [&](auto&& fn) {
+        double best = 0.0;
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto s = Timer::now();
+            fn();
+            double elapsed = Timer::elapsed(s, Timer::now());
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return best;
+    };
+
+    auto max_abs_diff = [](const float* a, const float* b, size_t n) {
+        double worst = 0.0;
+        for (size_t i = 0; i < n; i++)
+            worst = std::max(worst, (double)std::fabs(a[i] - b[i]));
+        return worst;
+    };
+
+    auto rel_err = [](double approx, double exact) {
+        return exact != 0.0 ? std::fabs(approx - exact) / std::fabs(exact) : std::fabs(approx);
+    };
+
+    const auto ref_rollup = omp_olap::rollup_time_mean(cube);
+    const float ref_global = omp_olap::global_mean(cube);
+    const float ref_region = omp_olap::region_mean(cube, 0, T, LAT / 4, LAT / 2, LON / 4, LON / 2);
+
+    const double f32_rollup = best_of([&] { omp_olap::rollup_time_mean(cube); });
+    const double f32_global = best_of([&] { omp_olap::global_mean(cube); });
+
+    std::ofstream file(path);
+    file << "format,mib,rollup_time_mean_time,global_mean_time,"
+            "max_cell_error,max_rollup_error,global_mean_rel_error,region_mean_rel_error\n";
+
+    file << "fp32," << cube.size() * sizeof(float) / (1024.0 * 1024.0) << ","
+         << f32_rollup << "," << f32_global << ",0,0,0,0\n";
+
+    std::cout << "  " << std::left << std::setw(8) << "format"
+              << std::setw(10) << "MiB"
+              << std::setw(14) << "rollup(s)"
+              << std::setw(14) << "global(s)"
+              << std::setw(14) << "max cell err"
+              << std::setw(14) << "rollup err"
+              << "global rel err\n";
+
+    std::cout << "  " << std::left << std::setw(8) << "fp32"
+              << std::setw(10) << cube.size() * sizeof(float) / (1024.0 * 1024.0)
+              << std::setw(14) << f32_rollup
+              << std::setw(14) << f32_global
+              << std::setw(14) << 0
+              << std::setw(14) << 0
+              << 0 << "\n";
+
+    for (QuantFormat format : {QuantFormat::Half, QuantFormat::ScaledInt16})
+    {
+        auto q = QuantizedCube::from_cube(cube, format);
+
+        const double rollup = best_of([&] { quant_olap::rollup_time_mean(q); });
+        const double global = best_of([&] { quant_olap::global_mean(q); });
+
+        const auto decoded = q.to_cube<SimpleCube<float>>();
+        const double cell_err = max_abs_diff(decoded.data(), cube.data(), cube.size());
+        const auto q_rollup = quant_olap::rollup_time_mean(q);
+        const double rollup_err = max_abs_diff(q_rollup.data(), ref_rollup.data(), ref_rollup.size());
+        const double global_err = rel_err(quant_olap::global_mean(q), ref_global);
+        const double region_err = rel_err(
+            quant_olap::region_mean(q, 0, T, LAT / 4, LAT / 2, LON / 4, LON / 2), ref_region);
+
+        const double mib = q.bytes() / (1024.0 * 1024.0);
+
+        std::cout << "  " << std::left << std::setw(8) << quant_format_name(format)
+                  << std::setw(10) << mib
+                  << std::setw(14) << rollup
+                  << std::setw(14) << global
+                  << std::setw(14) << cell_err
+                  << std::setw(14) << rollup_err
+                  << global_err << "\n";
+
+        file << quant_format_name(format) << ","
+             << mib << ","
+             << rollup << ","
+             << global << ","
+             << cell_err << ","
+             << rollup_err << ","
+             << global_err << ","
+             << region_err << "\n";
+    }
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../utils/timer.h"
+#include "../utils/thread_pool.h"
+#include "../cube/simple_cube.h"
+#include "../olap/parallel_operations.h"
+
+namespace benchmark {
+
+// parallel_olap queries dispatched the old way (fresh std::threads spawned
+// and joined per call) vs on the shared ThreadPool, from a one-hour slice
+// up to the whole cube. Both run the same per-row kernel with the same
+// number of parts; reported times are microseconds per call.
+inline void run_pool_overhead_comparison(
+    const SimpleCube<float>& cube,
+    const std::string& path = "pool_results.csv")
+{
+    ThreadPool& pool = ThreadPool::instance();
+    const unsigned int parts = pool.size();
+
+    std::cout << "\n=== Dispatch: spawn per call vs thread pool ("
+              << parts << " threads" << (pool.pinned() ? ", pinned" : "") << ") ===\n";
+
+    const int RUNS = 5;
+
+    const size_t T = cube.time_dim();
+    const size_t LAT = cube.lat_dim();
+
+    // [begin, end) in parts ranges, one std::thread each, as parallel_olap did
+    auto spawn_for_range = [&](size_t begin, size_t end, auto&& fn) {
+        const size_t per_part = (end - begin + parts - 1) / parts;
+        std::vector<std::thread> threads;
+        for (unsigned int p = 0; p < parts; ++p) {
+            size_t start = begin + p * per_part;
+            if (start >= end) break;
+            threads.emplace_back(fn, p, start, std::min(start + per_part, end));
+        }
+        for (auto& th : threads)
+            th.join();
+    };
+
+    // parallel_olap::rollup_time_sum with the spawn dispatch above
+    auto spawn_rollup = [&](const CubeView<float>& view) {
+        SimpleCube<float> result(1, view.lat_dim(), view.lon_dim());
+        const size_t LON = view.lon_dim();
+
+        spawn_for_range(0, view.lat_dim(), [&](size_t, size_t lat_start, size_t lat_end) {
+            for (size_t lat = lat_start; lat < lat_end; ++lat) {
+                float* acc = result.row(0, lat);
+                for (size_t t = 0; t < view.time_dim(); ++t) {
+                    const float* src = view.row(t, lat);
+                    #pragma omp simd
+                    for (size_t lon = 0; lon < LON; ++lon)
+                        acc[lon] += src[lon];
+                }
+            }
+        });
+        return result;
+    };
+
+    // Mean time per call over calls calls, best of RUNS batches
+    auto per_call = [&](int calls, auto&& fn) {
+        double best = 0.0;
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto s = Timer::now();
+            for (int c = 0; c < calls; c++)
+                fn();
+            double elapsed = Timer::elapsed(s, Timer::now()) / calls;
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return best * 1e6;
+    };
+
+    struct Query { std::string name; size_t hours; int calls; };
+    const std::vector<Query> queries = {
+        {"rollup_1h",   1,                     200},
+        {"rollup_24h",  std::min<size_t>(24, T),  100},
+        {"rollup_168h", std::min<size_t>(168, T), 20},
+        {"rollup_all",  T,                     3},
+    };
+
+    std::ofstream file(path);
+    file << "query,hours,spawn_us,pool_us,speedup_pool\n";
+
+    std::cout << "  " << std::left << std::setw(14) << "query"
+              << std::setw(8) << "hours"
+              << std::setw(14) << "spawn(us)"
+              << std::setw(14) << "pool(us)"
+              << "speedup\n";
+
+    for (const auto& q : queries)
+    {
+        if (q.hours == 0 || LAT == 0)
+            continue;
+
+        auto view = parallel_olap::dice_time(cube, 0, q.hours);
+
+        const double spawn = per_call(q.calls, [&] { spawn_rollup(view); });
+        const double pooled = per_call(q.calls, [&] { parallel_olap::rollup_time_sum(view); });
+
+        std::cout << "  " << std::left << std::setw(14) << q.name
+                  << std::setw(8) << q.hours
+                  << std::setw(14) << spawn
+                  << std::setw(14) << pooled
+                  << spawn / pooled << "\n";
+
+        file << q.name << ","
+             << q.hours << ","
+             << spawn << ","
+             << pooled << ","
+             << spawn / pooled << "\n";
+    }
+
+    // Dispatch alone: an empty body on every part
+    const double spawn_empty = per_call(1000, [&] {
+        spawn_for_range(0, parts, [](size_t, size_t, size_t) {});
+    });
+    const double pool_empty = per_call(1000, [&] {
+        pool.parallel_for(parts, [](size_t) {});
+    });
+
+    std::cout << "  " << std::left << std::setw(14) << "empty"
+              << std::setw(8) << 0
+              << std::setw(14) << spawn_empty
+              << std::setw(14) << pool_empty
+              << spawn_empty / pool_empty << "\n";
+
+    file << "empty,0," << spawn_empty << "," << pool_empty << ","
+         << spawn_empty / pool_empty << "\n";
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../utils/timer.h"
+#include "../cube/simple_cube.h"
+#include "../olap/reduce.h"
+
+namespace benchmark {
+
+// Several statistics from one fused reduce() call vs one reduce() call
+// per statistic, for the time, lon (zonal) and lat (meridional)
+// reductions. Reported times are milliseconds, best of RUNS.
+inline void run_reduce_fusion_comparison(
+    const SimpleCube<float>& cube,
+    const std::string& path = "reduce_results.csv")
+{
+    using namespace reduce_olap;
+
+    std::cout << "\n=== Axis reductions: fused vs one pass per statistic ===\n";
+
+    const int RUNS = 5;
+
+    auto best_ms = [&](auto&& fn) {
+        double best = 0.0;
+        for (int r = 0; r < RUNS; r++)
+        {
+            auto s = Timer::now();
+            fn();
+            double elapsed = Timer::elapsed(s, Timer::now());
+            best = (r == 0) ? elapsed : std::min(best, elapsed);
+        }
+        return best * 1e3;
+    };
+
+    struct Query { std::string name; unsigned axes; };
+    const std::vector<Query> queries = {
+        {"time",       axis::t},
+        {"zonal",      axis::lon},
+        {"meridional", axis::lat},
+    };
+
+    std::ofstream file(path);
+    file << "reduction,separate_ms,fused_ms,speedup_fused\n";
+
+    std::cout << "  " << std::left << std::setw(14) << "reduction"
+              << std::setw(16) << "separate(ms)"
+              << std::setw(14) << "fused(ms)"
+              << "speedup\n";
+
+    for (const auto& q : queries)
+    {
+        // mean, max, argmax, std
+        const double separate = best_ms([&] {
+            reduce(cube, q.axes, Mean{});
+            reduce(cube, q.axes, Max{});
+            reduce(cube, q.axes, ArgMax{});
+            reduce(cube, q.axes, Std{});
+        });
+        const double fused = best_ms([&] {
+            reduce(cube, q.axes, Mean{}, Max{}, ArgMax{}, Std{});
+        });
+
+        std::cout << "  " << std::left << std::setw(14) << q.name
+                  << std::setw(16) << separate
+                  << std::setw(14) << fused
+                  << separate / fused << "\n";
+
+        file << q.name << ","
+             << separate << ","
+             << fused << ","
+             << separate / fused << "\n";
+    }
+
+    std::cout << "Results written to " << path << "\n";
+}
+
+}
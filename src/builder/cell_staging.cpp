@@ -0,0 +1,83 @@
+#include "cell_staging.h"
+
+#include <limits>
+#include <stdexcept>
+#include <omp.h>
+
+CellStaging
+CellStaging::stage(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    const GridSpec& grid,
+    unsigned int num_threads)
+{
+    if (num_threads == 0)
+        num_threads = omp_get_max_threads();
+
+    const size_t lat_bins = grid.lat_bins();
+    const size_t lon_bins = grid.lon_bins();
+
+    if (axis.size() * lat_bins * lon_bins >
+        std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Cube too large for 32-bit cell ids");
+
+    const size_t N = lat.size();
+
+    CellStaging staging;
+    std::vector<size_t> offsets;
+
+#pragma omp parallel num_threads(num_threads)
+    {
+        const size_t nt  = omp_get_num_threads();
+        const size_t tid = omp_get_thread_num();
+
+        const size_t i_begin = N * tid / nt;
+        const size_t i_end   = N * (tid + 1) / nt;
+
+#pragma omp single
+        offsets.assign(nt + 1, 0);
+
+        // ---- Count pass ----
+        uint32_t cell;
+        size_t kept = 0;
+
+        for (size_t i = i_begin; i < i_end; ++i)
+        {
+            if (cell_of(grid, axis, lat_bins, lon_bins,
+                        lat[i], lon[i], nsr[i], hours[i], cell))
+                ++kept;
+        }
+
+        offsets[tid + 1] = kept;
+
+#pragma omp barrier
+
+#pragma omp single
+        {
+            for (size_t w = 0; w < nt; ++w)
+                offsets[w + 1] += offsets[w];
+
+            staging.cell.resize(offsets[nt]);
+            staging.value.resize(offsets[nt]);
+        }
+
+        // ---- Fill pass ----
+        size_t out = offsets[tid];
+
+        for (size_t i = i_begin; i < i_end; ++i)
+        {
+            if (cell_of(grid, axis, lat_bins, lon_bins,
+                        lat[i], lon[i], nsr[i], hours[i], cell))
+            {
+                staging.cell[out] = cell;
+                staging.value[out] = nsr[i];
+                ++out;
+            }
+        }
+    }
+
+    return staging;
+}
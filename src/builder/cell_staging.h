@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../cube/grid_spec.h"
+#include "../cube/time_axis.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Binned observations staged as structure-of-arrays:
+// a 32-bit linear cell id (t×LAT×LON + lat×LON + lon) plus the value,
+// 8 bytes per observation instead of a padded 32-byte struct.
+struct CellStaging {
+    std::vector<uint32_t> cell;
+    std::vector<float> value;
+
+    size_t size() const { return cell.size(); }
+
+    // Parallel count pass sizes the arrays exactly, then a second pass
+    // fills them; observation order is preserved.
+    static CellStaging stage(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        const TimeAxis& axis,
+        const GridSpec& grid,
+        unsigned int num_threads = 0
+    );
+};
+
+// Linear cell id of an observation; false if it is dropped
+// (outside the grid or time axis, or a fill value)
+inline bool cell_of(const GridSpec& grid,
+                    const TimeAxis& axis,
+                    size_t lat_bins,
+                    size_t lon_bins,
+                    float lat,
+                    float lon,
+                    float value,
+                    int32_t hour,
+                    uint32_t& cell)
+{
+    if (!(value > -9000))
+        return false;
+
+    int32_t t = axis.index(hour);
+    if (t < 0)
+        return false;
+
+    size_t lat_idx, lon_idx;
+    if (!grid.bin(lat, lon, lat_idx, lon_idx))
+        return false;
+
+    cell = static_cast<uint32_t>(
+        (static_cast<size_t>(t) * lat_bins + lat_idx) * lon_bins + lon_idx);
+    return true;
+}
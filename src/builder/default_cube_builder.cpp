@@ -1,5 +1,7 @@
 #include "default_cube_builder.h"
-#include <unordered_map>
+#include "../cube/grid_spec.h"
+#include "../cube/time_axis.h"
+#include "../utils/time_utils.h"
 #include <cmath>
 #include <iostream>
 
@@ -10,31 +12,36 @@ DefaultCubeBuilder::build(
     const std::vector<float>& nsr,
     const std::vector<std::string>& timestamps)
 {
-    // ---- Hardcoded defaults ----
-    const double lat_min = 5.0;
-    const double lat_max = 40.0;
-    const double lon_min = 65.0;
-    const double lon_max = 100.0;
-    const double resolution = 0.25;
+    return build(lat, lon, nsr, timeutil::to_epoch_hours(timestamps));
+}
 
-    size_t lat_bins =
-        std::ceil((lat_max - lat_min) / resolution);
-    size_t lon_bins =
-        std::ceil((lon_max - lon_min) / resolution);
+Datacube<float>
+DefaultCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours)
+{
+    return build(lat, lon, nsr, hours, TimeAxis::from_hours(hours));
+}
 
-    // ---- Build hourly time index ----
-    std::unordered_map<std::string, size_t> time_index;
-    size_t time_counter = 0;
+Datacube<float>
+DefaultCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    ValidityMask* valid)
+{
+    // ---- Hardcoded defaults ----
+    const GridSpec grid;
 
-    for (const auto& ts : timestamps)
-    {
-        std::string hour = ts.substr(0, 13); // YYYY-MM-DDTHH
+    size_t lat_bins = grid.lat_bins();
+    size_t lon_bins = grid.lon_bins();
 
-        if (time_index.find(hour) == time_index.end())
-        {
-            time_index[hour] = time_counter++;
-        }
-    }
+    // ---- Hourly time axis (chronological) ----
+    size_t time_counter = axis.size();
 
     std::cout << "Building cube: "
               << time_counter << " × "
@@ -55,17 +62,13 @@ DefaultCubeBuilder::build(
     // ---- Binning ----
     for (size_t i = 0; i < lat.size(); ++i)
     {
-        const std::string hour = timestamps[i].substr(0, 13);
-        size_t t = time_index[hour];
+        int32_t t = axis.index(hours[i]);
+        if (t < 0)
+            continue;
 
-        size_t lat_idx =
-            (lat[i] - lat_min) / resolution;
+        size_t lat_idx, lon_idx;
 
-        size_t lon_idx =
-            (lon[i] - lon_min) / resolution;
-
-        if (lat_idx < lat_bins &&
-            lon_idx < lon_bins)
+        if (grid.bin(lat[i], lon[i], lat_idx, lon_idx))
         {
             float v = nsr[i];
             if(v> -9000)
@@ -92,5 +95,8 @@ DefaultCubeBuilder::build(
         }
     }
 
+    if (valid)
+        *valid = ValidityMask::from_counts(count);
+
     return cube;
 }
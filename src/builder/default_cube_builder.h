@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../cube/datacube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+#include <cstdint>
+#include <string>
 #include <vector>
 
 
@@ -12,4 +16,23 @@ public:
       const std::vector<float>& lnsr,
       const std::vector<std::string>& timestamps
     );
+
+    // hours: timestamps already decoded to hours since epoch
+    static Datacube<float> build(
+      const std::vector<float>& lat,
+      const std::vector<float>& lon,
+      const std::vector<float>& lnsr,
+      const std::vector<int32_t>& hours
+    );
+
+    // axis: time axis shared with other builders and queries
+    // valid: if given, receives the mask of cells with observations
+    static Datacube<float> build(
+      const std::vector<float>& lat,
+      const std::vector<float>& lon,
+      const std::vector<float>& lnsr,
+      const std::vector<int32_t>& hours,
+      const TimeAxis& axis,
+      ValidityMask* valid = nullptr
+    );
 };
@@ -1,7 +1,14 @@
 #include "omp_sc_builder.h"
+#include "../cube/time_axis.h"
+#include "cell_staging.h"
+#include "../utils/time_utils.h"
 
-#include <unordered_map>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
 #include <iostream>
 #include <omp.h>
 
@@ -13,152 +20,348 @@ OMPSimpleCubeBuilder::build(
     const std::vector<std::string>& timestamps,
     unsigned int num_threads)
 {
-    if (num_threads == 0)
-        num_threads = omp_get_max_threads();
+    return build(lat, lon, nsr,
+                 timeutil::to_epoch_hours(timestamps),
+                 num_threads);
+}
 
-    omp_set_num_threads(num_threads);
+SimpleCube<float>
+OMPSimpleCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    unsigned int num_threads)
+{
+    return build(lat, lon, nsr, hours,
+                 TimeAxis::from_hours(hours),
+                 num_threads);
+}
 
-    const double lat_min = 5.0;
-    const double lat_max = 40.0;
-    const double lon_min = 65.0;
-    const double lon_max = 100.0;
-    const double resolution = 0.25;
+namespace {
 
-    size_t lat_bins = std::ceil((lat_max - lat_min) / resolution);
-    size_t lon_bins = std::ceil((lon_max - lon_min) / resolution);
+// Observations counting-sorted into time-contiguous buckets, with the
+// time range each worker owns when accumulating
+struct TimeBuckets {
+    std::vector<size_t> bucket_start;    // [t] first slot of bucket t, T+1 entries
+    std::vector<size_t> t_split;         // [worker] first t owned, workers+1 entries
 
-    // ----------------------------
-    // Build hourly time index
-    // ----------------------------
+    // Time-sorted staging, structure-of-arrays: 8 bytes per observation
+    std::unique_ptr<uint32_t[]> cell;
+    std::unique_ptr<float[]> value;
 
-    std::unordered_map<std::string,size_t> time_index;
-    size_t time_counter = 0;
+    size_t workers() const { return t_split.size() - 1; }
+};
 
-    for(const auto& ts : timestamps)
+// Counting sort by time bin. Every observation is touched a constant
+// number of times no matter how many threads run, and each worker later
+// only reads its own buckets.
+TimeBuckets partition_by_time(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    const GridSpec& grid,
+    unsigned int num_threads)
+{
+    const size_t lat_bins = grid.lat_bins();
+    const size_t lon_bins = grid.lon_bins();
+    const size_t plane = lat_bins * lon_bins;
+
+    const size_t N = lat.size();
+    const size_t T = axis.size();
+
+    TimeBuckets b;
+    std::vector<size_t> hist;            // [thread][t] observations
+
+#pragma omp parallel num_threads(num_threads)
     {
-        std::string hour = ts.substr(0,13);
+        const size_t nt  = omp_get_num_threads();
+        const size_t tid = omp_get_thread_num();
 
-        if(time_index.find(hour) == time_index.end())
-            time_index[hour] = time_counter++;
-    }
+        // Same observation range in both passes, so the scatter offsets
+        // computed from this thread's histogram line up
+        const size_t i_begin = N * tid / nt;
+        const size_t i_end   = N * (tid + 1) / nt;
 
-    std::cout << "Building OMP simple cube: "
-              << time_counter << " × "
-              << lat_bins << " × "
-              << lon_bins << " using "
-              << num_threads << " threads\n";
+#pragma omp single
+        hist.assign(nt * T, 0);
 
-    // ----------------------------
-    // Prepare bin_data with time info
-    // ----------------------------
+        // ---- Pass 1: per-thread histogram over time bins ----
+        size_t* my_hist = hist.data() + tid * T;
+        uint32_t cell;
 
-    double inv_res = 1.0 / resolution;
+        for(size_t i = i_begin; i < i_end; i++)
+        {
+            if(cell_of(grid, axis, lat_bins, lon_bins,
+                       lat[i], lon[i], nsr[i], hours[i], cell))
+                my_hist[cell / plane]++;
+        }
 
-    struct IndexedBin {
-        size_t t;
-        size_t lat_idx;
-        size_t lon_idx;
-        float value;
-    };
+#pragma omp barrier
 
-    std::vector<IndexedBin> bin_data;
-    bin_data.reserve(lat.size());
+        // ---- Prefix sum: bucket starts and per-thread write cursors ----
+#pragma omp single
+        {
+            b.bucket_start.assign(T + 1, 0);
 
-    for(size_t i = 0; i < lat.size(); i++)
-    {
-        const float lat_val = lat[i];
-        const float lon_val = lon[i];
-        const float v       = nsr[i];
+            size_t running = 0;
+            for(size_t t = 0; t < T; t++)
+            {
+                b.bucket_start[t] = running;
+                for(size_t w = 0; w < nt; w++)
+                {
+                    size_t c = hist[w * T + t];
+                    hist[w * T + t] = running;
+                    running += c;
+                }
+            }
+            b.bucket_start[T] = running;
 
-        std::string_view hour(timestamps[i].data(),13);
-        auto it = time_index.find(std::string(hour));
-        size_t t = it->second;
+            b.cell.reset(new uint32_t[running]);
+            b.value.reset(new float[running]);
 
-        size_t lat_idx = static_cast<size_t>((lat_val - lat_min) * inv_res);
-        size_t lon_idx = static_cast<size_t>((lon_val - lon_min) * inv_res);
+            // Contiguous time ranges holding ~equal observation counts
+            b.t_split.assign(nt + 1, T);
+            size_t t = 0;
+            for(size_t w = 0; w < nt; w++)
+            {
+                size_t target = running * w / nt;
+                while(t < T && b.bucket_start[t] < target)
+                    t++;
+                b.t_split[w] = t;
+            }
+            b.t_split[0] = 0;
+        }
 
-        if(lat_idx < lat_bins && lon_idx < lon_bins && v > -9000)
+        // ---- Pass 2: scatter into time-contiguous buckets ----
+        for(size_t i = i_begin; i < i_end; i++)
         {
-            bin_data.push_back({t, lat_idx, lon_idx, v});
+            if(cell_of(grid, axis, lat_bins, lon_bins,
+                       lat[i], lon[i], nsr[i], hours[i], cell))
+            {
+                size_t slot = my_hist[cell / plane]++;
+                b.cell[slot] = cell;
+                b.value[slot] = nsr[i];
+            }
         }
     }
 
+    return b;
+}
+
+size_t check_cube_size(const TimeAxis& axis, const GridSpec& grid)
+{
+    size_t time_counter = axis.size();
+
+    if (time_counter * grid.lat_bins() * grid.lon_bins() > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Cube too large for 32-bit cell ids");
+
+    return time_counter;
+}
+
+} // namespace
+
+SimpleCube<float>
+OMPSimpleCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    unsigned int num_threads,
+    SimpleCube<int>* counts,
+    ValidityMask* valid,
+    MeasureCube* measures)
+{
+    if (num_threads == 0)
+        num_threads = omp_get_max_threads();
+
+    // ---- Hardcoded defaults ----
+    const GridSpec grid;
+
+    size_t lat_bins = grid.lat_bins();
+    size_t lon_bins = grid.lon_bins();
+
     // ----------------------------
-    // Partition by time dimension - key optimization
-    // Each thread gets exclusive time range, no atomics needed
+    // Hourly time axis (chronological)
     // ----------------------------
 
+    size_t time_counter = check_cube_size(axis, grid);
+
+    std::cout << "Building OMP simple cube: "
+              << time_counter << " × "
+              << lat_bins << " × "
+              << lon_bins << " using "
+              << num_threads << " threads\n";
+
     SimpleCube<float> cube(time_counter, lat_bins, lon_bins);
     cube.fill(0.0f);
 
     SimpleCube<int> count(time_counter, lat_bins, lon_bins);
     count.fill(0);
 
-    // Compute time ranges for each thread (contiguous T chunks for cache locality)
-    std::vector<std::pair<size_t, size_t>> thread_time_ranges(num_threads);
-    size_t t_per_thread = (time_counter + num_threads - 1) / num_threads;
-    
-    for(unsigned int tid = 0; tid < num_threads; tid++)
-    {
-        size_t t_start = tid * t_per_thread;
-        size_t t_end   = std::min(t_start + t_per_thread, time_counter);
-        thread_time_ranges[tid] = {t_start, t_end};
-    }
+    if(measures)
+        measures->reset(time_counter, lat_bins, lon_bins);
 
-    // ----------------------------
-    // Parallel binning - time-partitioned (no atomics!)
-    // ----------------------------
+    const TimeBuckets b = partition_by_time(lat, lon, nsr, hours, axis, grid, num_threads);
+    const size_t workers = b.workers();
 
-#pragma omp parallel
+    // ---- Accumulate + normalize each worker's time range only ----
+#pragma omp parallel for schedule(static, 1) num_threads(workers)
+    for(size_t w = 0; w < workers; w++)
     {
-        unsigned int tid = omp_get_thread_num();
-        auto [t_start, t_end] = thread_time_ranges[tid];
-
-        // Thread-local accumulators for assigned time range
-        std::vector<std::vector<std::vector<float>>> local_sum(t_end - t_start);
-        std::vector<std::vector<std::vector<int>>> local_cnt(t_end - t_start);
+        const size_t t_begin = b.t_split[w];
+        const size_t t_end   = b.t_split[w + 1];
 
-        for(size_t t_off = 0; t_off < t_end - t_start; t_off++)
+        // Cell ids are flat (t, lat, lon) offsets, so both passes index
+        // the cubes directly; the measures pass also feeds every value to
+        // MeasureCube::add before summing it
+        if(measures)
         {
-            local_sum[t_off].resize(lat_bins);
-            local_cnt[t_off].resize(lat_bins);
-            for(size_t lat = 0; lat < lat_bins; lat++)
+            for(size_t k = b.bucket_start[t_begin]; k < b.bucket_start[t_end]; k++)
             {
-                local_sum[t_off][lat].resize(lon_bins, 0.0f);
-                local_cnt[t_off][lat].resize(lon_bins, 0);
+                size_t c = b.cell[k];
+                measures->add(c, b.value[k], cube.data()[c], count.data()[c]);
+                cube.data()[c] += b.value[k];
+                count.data()[c] += 1;
             }
         }
-
-        // Build reverse index: which bins belong to this thread's time range?
-        // Scan all data, accumulate into local buffers if in our time range
-        for(const auto& bd : bin_data)
+        else
         {
-            if(bd.t >= t_start && bd.t < t_end)
+            for(size_t k = b.bucket_start[t_begin]; k < b.bucket_start[t_end]; k++)
             {
-                size_t t_off = bd.t - t_start;
-                local_sum[t_off][bd.lat_idx][bd.lon_idx] += bd.value;
-                local_cnt[t_off][bd.lat_idx][bd.lon_idx] += 1;
+                size_t c = b.cell[k];
+                cube.data()[c] += b.value[k];
+                count.data()[c] += 1;
             }
         }
 
-        // Merge local results into global cube (no contention - exclusive time ranges)
-        for(size_t t_off = 0; t_off < t_end - t_start; t_off++)
+        for(size_t t = t_begin; t < t_end; t++)
         {
-            size_t t = t_start + t_off;
-            for(size_t lat = 0; lat < lat_bins; lat++)
+            for(size_t lat_i = 0; lat_i < lat_bins; lat_i++)
             {
-                for(size_t lon = 0; lon < lon_bins; lon++)
+                for(size_t lon_i = 0; lon_i < lon_bins; lon_i++)
                 {
-                    int c = local_cnt[t_off][lat][lon];
+                    if(measures)
+                        measures->finish(cube.offset(t, lat_i, lon_i),
+                                         cube.at(t, lat_i, lon_i), count.at(t, lat_i, lon_i));
+
+                    int c = count.at(t, lat_i, lon_i);
                     if(c > 0)
-                    {
-                        cube.at(t, lat, lon) = local_sum[t_off][lat][lon] / c;
-                        count.at(t, lat, lon) = c;
-                    }
+                        cube.at(t, lat_i, lon_i) /= c;
                 }
             }
         }
     }
 
+    if(valid)
+        *valid = ValidityMask::from_counts(count);
+
+    if(counts)
+        *counts = std::move(count);
+
     return cube;
 }
+
+SparseCube<float>
+OMPSimpleCubeBuilder::build_sparse(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    unsigned int num_threads)
+{
+    if (num_threads == 0)
+        num_threads = omp_get_max_threads();
+
+    const GridSpec grid;
+
+    size_t lat_bins = grid.lat_bins();
+    size_t lon_bins = grid.lon_bins();
+
+    size_t time_counter = check_cube_size(axis, grid);
+
+    if (lon_bins > std::numeric_limits<SparseCube<float>::index_type>::max())
+        throw std::runtime_error("Grid too wide for sparse cube");
+
+    std::cout << "Building OMP sparse cube: "
+              << time_counter << " × "
+              << lat_bins << " × "
+              << lon_bins << " using "
+              << num_threads << " threads\n";
+
+    const size_t plane = lat_bins * lon_bins;
+
+    const TimeBuckets b = partition_by_time(lat, lon, nsr, hours, axis, grid, num_threads);
+    const size_t workers = b.workers();
+
+    // Row (t, lat) cell counts, turned into CSR offsets below
+    std::vector<size_t> starts(time_counter * lat_bins + 1, 0);
+
+    std::vector<std::vector<SparseCube<float>::index_type>> part_lon(workers);
+    std::vector<std::vector<float>> part_value(workers);
+
+    // ---- Accumulate each worker's time range hour by hour ----
+    // Only the cells observed in an hour are touched: a plane-sized
+    // scratch sums them, then they are emitted in (lat, lon) order and
+    // the scratch is reset, so no dense cube is ever allocated.
+#pragma omp parallel for schedule(static, 1) num_threads(workers)
+    for(size_t w = 0; w < workers; w++)
+    {
+        std::vector<float> sum(plane, 0.0f);
+        std::vector<int> count(plane, 0);
+        std::vector<uint32_t> touched;
+
+        auto& out_lon = part_lon[w];
+        auto& out_value = part_value[w];
+
+        for(size_t t = b.t_split[w]; t < b.t_split[w + 1]; t++)
+        {
+            touched.clear();
+
+            for(size_t k = b.bucket_start[t]; k < b.bucket_start[t + 1]; k++)
+            {
+                uint32_t c = static_cast<uint32_t>(b.cell[k] % plane);
+                if(count[c]++ == 0)
+                    touched.push_back(c);
+                sum[c] += b.value[k];
+            }
+
+            std::sort(touched.begin(), touched.end());
+
+            for(uint32_t c : touched)
+            {
+                float mean = sum[c] / count[c];
+                if(mean != 0.0f)
+                {
+                    out_lon.push_back(static_cast<SparseCube<float>::index_type>(c % lon_bins));
+                    out_value.push_back(mean);
+                    starts[t * lat_bins + c / lon_bins + 1]++;
+                }
+                sum[c] = 0.0f;
+                count[c] = 0;
+            }
+        }
+    }
+
+    for(size_t r = 0; r + 1 < starts.size(); r++)
+        starts[r + 1] += starts[r];
+
+    std::vector<SparseCube<float>::index_type> lons(starts.back());
+    std::vector<float> values(starts.back());
+
+    // Worker ranges are contiguous in t, so each part lands in one block
+#pragma omp parallel for schedule(static, 1) num_threads(workers)
+    for(size_t w = 0; w < workers; w++)
+    {
+        size_t offset = starts[b.t_split[w] * lat_bins];
+        std::copy(part_lon[w].begin(), part_lon[w].end(), lons.begin() + offset);
+        std::copy(part_value[w].begin(), part_value[w].end(), values.begin() + offset);
+    }
+
+    return SparseCube<float>(time_counter, lat_bins, lon_bins,
+                             std::move(starts), std::move(lons), std::move(values));
+}
@@ -1,6 +1,11 @@
 #pragma once
 
 #include "../cube/simple_cube.h"
+#include "../cube/sparse_cube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+#include "../cube/measure_cube.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -16,13 +21,39 @@ public:
         unsigned int num_threads = 0
     );
 
-private:
+    // hours: timestamps already decoded to hours since epoch
+    static SimpleCube<float> build(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        unsigned int num_threads = 0
+    );
 
-    struct BinData
-    {
-        size_t t;
-        size_t lat_idx;
-        size_t lon_idx;
-        float value;
-    };
+    // axis: time axis shared with other builders and queries
+    // counts: if given, receives the per-cell observation counts
+    // valid: if given, receives the mask of cells with observations
+    // measures: if given, its requested measures are accumulated too
+    static SimpleCube<float> build(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        const TimeAxis& axis,
+        unsigned int num_threads = 0,
+        SimpleCube<int>* counts = nullptr,
+        ValidityMask* valid = nullptr,
+        MeasureCube* measures = nullptr
+    );
+
+    // Same binning, emitted straight into a SparseCube: memory scales
+    // with the non-zero cells instead of T × LAT × LON
+    static SparseCube<float> build_sparse(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        const TimeAxis& axis,
+        unsigned int num_threads = 0
+    );
 };
@@ -1,8 +1,14 @@
 #include "parallel_simple_cube_builder.h"
-#include <unordered_map>
+#include "cell_staging.h"
+#include "../cube/time_axis.h"
+#include "../utils/time_utils.h"
+#include "../utils/atomic_ops.h"
+#include "../utils/thread_pool.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <mutex>
+#include <unordered_map>
 
 
 SimpleCube<float>
@@ -13,99 +19,168 @@ ParallelSimpleCubeBuilder::build(
     const std::vector<std::string>& timestamps,
     unsigned int num_threads)
 {
+    return build(lat, lon, nsr,
+                 timeutil::to_epoch_hours(timestamps),
+                 num_threads);
+}
+
+SimpleCube<float>
+ParallelSimpleCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    unsigned int num_threads)
+{
+    return build(lat, lon, nsr, hours,
+                 TimeAxis::from_hours(hours),
+                 num_threads);
+}
+
+SimpleCube<float>
+ParallelSimpleCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    unsigned int num_threads,
+    Accumulation mode,
+    ValidityMask* valid)
+{
+    ThreadPool& pool = ThreadPool::instance();
+
     // Auto-detect threads
     if (num_threads == 0) {
-        num_threads = std::thread::hardware_concurrency();
-        if (num_threads == 0) num_threads = 4;
+        num_threads = pool.size();
     }
 
     // ---- Hardcoded defaults ----
-    const double lat_min = 5.0;
-    const double lat_max = 40.0;
-    const double lon_min = 65.0;
-    const double lon_max = 100.0;
-    const double resolution = 0.25;
-
-    size_t lat_bins = std::ceil((lat_max - lat_min) / resolution);
-    size_t lon_bins = std::ceil((lon_max - lon_min) / resolution);
-
-    // ---- Build hourly time index ----
-    std::unordered_map<std::string, size_t> time_index;
-    size_t time_counter = 0;
-
-    for (const auto& ts : timestamps) {
-        // std::string hour = ts.substr(0, 13);
-        // if (time_index.find(hour) == time_index.end()) {
-        //     time_index[hour] = time_counter++;
-        // }
-
-        std::string_view hour(ts.data(), 13);
-
-        auto it = time_index.find(std::string(hour));
-        if (it == time_index.end())
-        {
-            time_index.emplace(std::string(hour), time_counter++);
-        }
-    }
+    const GridSpec grid;
+
+    size_t lat_bins = grid.lat_bins();
+    size_t lon_bins = grid.lon_bins();
+
+    // ---- Hourly time axis (chronological) ----
+    size_t time_counter = axis.size();
 
     std::cout << "Building parallel simple cube: "
               << time_counter << " × " << lat_bins << " × " << lon_bins
-              << " using " << num_threads << " threads\n";
+              << " using " << num_threads << " threads ("
+              << accumulation_name(mode) << ")\n";
 
     SimpleCube<float> cube(time_counter, lat_bins, lon_bins);
     SimpleCube<int> count(time_counter, lat_bins, lon_bins);
     cube.fill(0.0f);
     count.fill(0);
 
-    // ---- Prepare binning data ----
-    std::vector<BinData> bin_data;
-    bin_data.reserve(lat.size());
+    // ---- Stage packed cell ids (exact-size, parallel count pass) ----
+    CellStaging staging = CellStaging::stage(
+        lat, lon, nsr, hours, axis, grid, num_threads);
 
-    for (size_t i = 0; i < lat.size(); ++i) {
-        const std::string hour = timestamps[i].substr(0, 13);
-        size_t t = time_index[hour];
-        size_t lat_idx = (lat[i] - lat_min) / resolution;
-        size_t lon_idx = (lon[i] - lon_min) / resolution;
+    const size_t plane = lat_bins * lon_bins;
 
-        if (lat_idx < lat_bins && lon_idx < lon_bins) {
-            float v = nsr[i];
-            if (v > -9000) {
-                bin_data.push_back({t, lat_idx, lon_idx, nsr[i]});
-            }
-        }
-    }
+    auto decode = [&](uint32_t cell, size_t& t, size_t& la, size_t& lo) {
+        t = cell / plane;
+        la = (cell % plane) / lon_bins;
+        lo = cell % lon_bins;
+    };
 
     // ---- Parallel binning ----
-    // Use mutex for thread-safe updates
-    std::vector<std::mutex> time_mutexes(time_counter);
+
+    // Privatized mode: one sparse (cell, sum, count) list per thread,
+    // sorted by linear cell id so the merge can split by time range
+    struct CellAcc {
+        uint32_t cell;
+        float sum;
+        int count;
+    };
+    std::vector<std::vector<CellAcc>> private_cells(num_threads);
+
+    std::vector<std::mutex> time_mutexes(
+        mode == Accumulation::Mutex ? time_counter : 0);
 
     auto bin_worker_mutex = [&](size_t start, size_t end) {
+        size_t t, la, lo;
         for (size_t i = start; i < end; ++i) {
-            const auto& bd = bin_data[i];
-            std::lock_guard<std::mutex> lock(time_mutexes[bd.t]);
-            cube.at(bd.t, bd.lat_idx, bd.lon_idx) += bd.value;
-            count.at(bd.t, bd.lat_idx, bd.lon_idx) += 1;
+            decode(staging.cell[i], t, la, lo);
+            std::lock_guard<std::mutex> lock(time_mutexes[t]);
+            cube.at(t, la, lo) += staging.value[i];
+            count.at(t, la, lo) += 1;
         }
     };
 
-    std::vector<std::thread> threads;
-    size_t data_per_thread = (bin_data.size() + num_threads - 1) / num_threads;
+    auto bin_worker_atomic = [&](size_t start, size_t end) {
+        size_t t, la, lo;
+        for (size_t i = start; i < end; ++i) {
+            decode(staging.cell[i], t, la, lo);
+            atomic_ops::fetch_add(cube.at(t, la, lo), staging.value[i]);
+            atomic_ops::fetch_add(count.at(t, la, lo), 1);
+        }
+    };
 
-    for (unsigned int t = 0; t < num_threads; ++t) {
-        size_t start = t * data_per_thread;
-        size_t end = std::min(start + data_per_thread, bin_data.size());
-        if (start >= bin_data.size()) break;
-        threads.emplace_back(bin_worker_mutex, start, end);
-    }
+    auto bin_worker_private = [&](size_t start, size_t end, unsigned int tid) {
+        std::unordered_map<uint32_t, size_t> slot;
+        std::vector<CellAcc>& cells = private_cells[tid];
+
+        for (size_t i = start; i < end; ++i) {
+            uint32_t cell = staging.cell[i];
+            float v = staging.value[i];
+
+            auto it = slot.find(cell);
+            if (it == slot.end()) {
+                slot.emplace(cell, cells.size());
+                cells.push_back({cell, v, 1});
+            } else {
+                cells[it->second].sum += v;
+                cells[it->second].count += 1;
+            }
+        }
 
-    for (auto& th : threads) {
-        th.join();
+        std::sort(cells.begin(), cells.end(),
+                  [](const CellAcc& a, const CellAcc& b) { return a.cell < b.cell; });
+    };
+
+    pool.parallel_for_range(0, staging.size(), [&](size_t part, size_t start, size_t end) {
+        switch (mode) {
+        case Accumulation::Mutex:
+            bin_worker_mutex(start, end);
+            break;
+        case Accumulation::Atomic:
+            bin_worker_atomic(start, end);
+            break;
+        case Accumulation::Privatized:
+            bin_worker_private(start, end, static_cast<unsigned int>(part));
+            break;
+        }
+    }, num_threads);
+
+    // ---- Privatized merge: each thread owns a time range of cells ----
+    if (mode == Accumulation::Privatized) {
+        auto merge_worker = [&](size_t t_start, size_t t_end) {
+            size_t lo = t_start * plane;
+            size_t hi = t_end * plane;
+
+            for (const auto& cells : private_cells) {
+                auto it = std::lower_bound(
+                    cells.begin(), cells.end(), lo,
+                    [](const CellAcc& a, size_t c) { return a.cell < c; });
+
+                size_t t, la, lo_idx;
+                for (; it != cells.end() && it->cell < hi; ++it) {
+                    decode(it->cell, t, la, lo_idx);
+                    cube.at(t, la, lo_idx) += it->sum;
+                    count.at(t, la, lo_idx) += it->count;
+                }
+            }
+        };
+
+        pool.parallel_for_range(0, time_counter, [&](size_t, size_t t_start, size_t t_end) {
+            merge_worker(t_start, t_end);
+        }, num_threads);
     }
 
     // ---- Parallel normalization ----
-    std::vector<std::thread> norm_threads;
-    size_t time_per_thread = (time_counter + num_threads - 1) / num_threads;
-
     auto normalize_worker = [&](size_t t_start, size_t t_end) {
         for (size_t t = t_start; t < t_end; ++t) {
             for (size_t la = 0; la < lat_bins; ++la) {
@@ -118,16 +193,23 @@ ParallelSimpleCubeBuilder::build(
         }
     };
 
-    for (unsigned int t = 0; t < num_threads; ++t) {
-        size_t t_start = t * time_per_thread;
-        size_t t_end = std::min(t_start + time_per_thread, time_counter);
-        if (t_start >= time_counter) break;
-        norm_threads.emplace_back(normalize_worker, t_start, t_end);
-    }
+    pool.parallel_for_range(0, time_counter, [&](size_t, size_t t_start, size_t t_end) {
+        normalize_worker(t_start, t_end);
+    }, num_threads);
 
-    for (auto& th : norm_threads) {
-        th.join();
-    }
+    if (valid)
+        *valid = ValidityMask::from_counts(count);
 
     return cube;
 }
+
+const char*
+ParallelSimpleCubeBuilder::accumulation_name(Accumulation mode)
+{
+    switch (mode) {
+    case Accumulation::Mutex:      return "mutex";
+    case Accumulation::Atomic:     return "atomic";
+    case Accumulation::Privatized: return "privatized";
+    }
+    return "unknown";
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "../cube/simple_cube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <thread>
@@ -9,6 +12,13 @@
 
 class ParallelSimpleCubeBuilder {
 public:
+    // How worker threads combine observations into shared cells
+    enum class Accumulation {
+        Mutex,      // lock per time slice
+        Atomic,     // lock-free fetch-add on each cell
+        Privatized  // per-thread sparse cell lists, merged by time range
+    };
+
     static SimpleCube<float> build(
         const std::vector<float>& lat,
         const std::vector<float>& lon,
@@ -17,32 +27,27 @@ public:
         unsigned int num_threads = 0  // 0 = auto-detect
     );
 
-private:
-    struct BinData {
-        size_t t;
-        size_t lat_idx;
-        size_t lon_idx;
-        float value;
-    };
-
-    // Thread worker for binning
-    static void bin_worker(
-        const std::vector<BinData>& input_data,
-        size_t start,
-        size_t end,
-        SimpleCube<float>& cube,
-        SimpleCube<int>& count,
-        size_t lat_bins,
-        size_t lon_bins
+    // hours: timestamps already decoded to hours since epoch
+    static SimpleCube<float> build(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        unsigned int num_threads = 0  // 0 = auto-detect
     );
 
-    // Thread worker for normalization
-    static void normalize_worker(
-        SimpleCube<float>& cube,
-        const SimpleCube<int>& count,
-        size_t t_start,
-        size_t t_end,
-        size_t lat_bins,
-        size_t lon_bins
+    // axis: time axis shared with other builders and queries
+    // valid: if given, receives the mask of cells with observations
+    static SimpleCube<float> build(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        const TimeAxis& axis,
+        unsigned int num_threads = 0,  // 0 = auto-detect
+        Accumulation mode = Accumulation::Mutex,
+        ValidityMask* valid = nullptr
     );
+
+    static const char* accumulation_name(Accumulation mode);
 };
@@ -1,5 +1,7 @@
 #include "simple_cube_builder.h"
-#include <unordered_map>
+#include "../cube/grid_spec.h"
+#include "../cube/time_axis.h"
+#include "../utils/time_utils.h"
 #include <cmath>
 #include <iostream>
 
@@ -9,33 +11,38 @@ SimpleCubeBuilder::build(
     const std::vector<float>& lon,
     const std::vector<float>& nsr,
     const std::vector<std::string>& timestamps)
+{
+    return build(lat, lon, nsr, timeutil::to_epoch_hours(timestamps));
+}
+
+SimpleCube<float>
+SimpleCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours)
+{
+    return build(lat, lon, nsr, hours, TimeAxis::from_hours(hours));
+}
+
+SimpleCube<float>
+SimpleCubeBuilder::build(
+    const std::vector<float>& lat,
+    const std::vector<float>& lon,
+    const std::vector<float>& nsr,
+    const std::vector<int32_t>& hours,
+    const TimeAxis& axis,
+    ValidityMask* valid,
+    MeasureCube* measures)
 {
     // ---- Hardcoded defaults ----
-    const double lat_min = 5.0;
-    const double lat_max = 40.0;
-    const double lon_min = 65.0;
-    const double lon_max = 100.0;
-    const double resolution = 0.25;
-
-    size_t lat_bins =
-        std::ceil((lat_max - lat_min) / resolution);
-    size_t lon_bins =
-        std::ceil((lon_max - lon_min) / resolution);
-
-    // ---- Build hourly time index ----
-    std::unordered_map<std::string, size_t> time_index;
-    size_t time_counter = 0;
-
-    for (const auto& ts : timestamps)
-    {
-        std::string_view hour(ts.data(), 13);
+    const GridSpec grid;
 
-        auto it = time_index.find(std::string(hour));
-        if (it == time_index.end())
-        {
-            time_index.emplace(std::string(hour), time_counter++);
-        }
-    }
+    size_t lat_bins = grid.lat_bins();
+    size_t lon_bins = grid.lon_bins();
+
+    // ---- Hourly time axis (chronological) ----
+    size_t time_counter = axis.size();
 
     std::cout << "Building simple cube: "
               << time_counter << " × "
@@ -53,24 +60,27 @@ SimpleCubeBuilder::build(
     cube.fill(0.0f);
     count.fill(0);
 
+    if (measures)
+        measures->reset(time_counter, lat_bins, lon_bins);
+
     // ---- Binning ----
     for (size_t i = 0; i < lat.size(); ++i)
     {
-        const std::string hour = timestamps[i].substr(0, 13);
-        size_t t = time_index[hour];
-
-        size_t lat_idx =
-            (lat[i] - lat_min) / resolution;
+        int32_t t = axis.index(hours[i]);
+        if (t < 0)
+            continue;
 
-        size_t lon_idx =
-            (lon[i] - lon_min) / resolution;
+        size_t lat_idx, lon_idx;
 
-        if (lat_idx < lat_bins &&
-            lon_idx < lon_bins)
+        if (grid.bin(lat[i], lon[i], lat_idx, lon_idx))
         {
             float v = nsr[i];
             if (v > -9000)
             {
+                if (measures)
+                    measures->add(cube.offset(t, lat_idx, lon_idx), v,
+                                  cube.at(t, lat_idx, lon_idx), count.at(t, lat_idx, lon_idx));
+
                 cube.at(t, lat_idx, lon_idx) += nsr[i];
                 count.at(t, lat_idx, lon_idx) += 1;
             }
@@ -84,6 +94,10 @@ SimpleCubeBuilder::build(
         {
             for (size_t lo = 0; lo < lon_bins; ++lo)
             {
+                if (measures)
+                    measures->finish(cube.offset(t, la, lo),
+                                     cube.at(t, la, lo), count.at(t, la, lo));
+
                 if (count.at(t, la, lo) > 0)
                 {
                     cube.at(t, la, lo) /=
@@ -93,5 +107,8 @@ SimpleCubeBuilder::build(
         }
     }
 
+    if (valid)
+        *valid = ValidityMask::from_counts(count);
+
     return cube;
 }
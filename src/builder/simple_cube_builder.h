@@ -1,6 +1,10 @@
 #pragma once
 
 #include "../cube/simple_cube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+#include "../cube/measure_cube.h"
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -13,4 +17,25 @@ public:
         const std::vector<float>& nsr,
         const std::vector<std::string>& timestamps
     );
+
+    // hours: timestamps already decoded to hours since epoch
+    static SimpleCube<float> build(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours
+    );
+
+    // axis: time axis shared with other builders and queries
+    // valid: if given, receives the mask of cells with observations
+    // measures: if given, its requested measures are accumulated too
+    static SimpleCube<float> build(
+        const std::vector<float>& lat,
+        const std::vector<float>& lon,
+        const std::vector<float>& nsr,
+        const std::vector<int32_t>& hours,
+        const TimeAxis& axis,
+        ValidityMask* valid = nullptr,
+        MeasureCube* measures = nullptr
+    );
 };
@@ -0,0 +1,149 @@
+#include "streaming_cube_builder.h"
+#include "cell_staging.h"
+#include "../cube/grid_spec.h"
+#include "../loader/zarr_loader.h"
+#include "../utils/atomic_ops.h"
+#include "../utils/time_utils.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+TimeAxis
+StreamingCubeBuilder::scan_time_axis(
+    const std::string& store_path,
+    unsigned int num_threads)
+{
+    num_threads = resolve_loader_threads(num_threads);
+
+    // Distinct hours seen by each worker; GPM chunks are time-ordered,
+    // so each chunk only contributes a handful
+    std::vector<std::vector<int32_t>> seen(num_threads);
+
+    ZarrLoader::stream_chunks(
+        store_path, {}, {"timestamps"},
+        [&](unsigned int worker, const ChunkBatch& batch)
+        {
+            std::vector<int32_t>& out = seen[worker];
+            const int32_t* hours = batch.hours[0];
+            int32_t last = timeutil::kInvalidHour;
+
+            for (size_t i = 0; i < batch.count; ++i)
+            {
+                if (hours[i] != timeutil::kInvalidHour && hours[i] != last)
+                {
+                    out.push_back(hours[i]);
+                    last = hours[i];
+                }
+            }
+
+            std::sort(out.begin(), out.end());
+            out.erase(std::unique(out.begin(), out.end()), out.end());
+        },
+        num_threads);
+
+    std::vector<int32_t> all;
+    for (const auto& s : seen)
+        all.insert(all.end(), s.begin(), s.end());
+
+    std::sort(all.begin(), all.end());
+    all.erase(std::unique(all.begin(), all.end()), all.end());
+
+    return TimeAxis::from_sorted_hours(std::move(all));
+}
+
+SimpleCube<float>
+StreamingCubeBuilder::build(
+    const std::string& store_path,
+    unsigned int num_threads,
+    LoadStats* stats,
+    ValidityMask* valid)
+{
+    TimeAxis axis = scan_time_axis(store_path, num_threads);
+    return build(store_path, axis, num_threads, stats, valid);
+}
+
+SimpleCube<float>
+StreamingCubeBuilder::build(
+    const std::string& store_path,
+    const TimeAxis& axis,
+    unsigned int num_threads,
+    LoadStats* stats,
+    ValidityMask* valid)
+{
+    // ---- Hardcoded defaults ----
+    const GridSpec grid;
+
+    size_t lat_bins = grid.lat_bins();
+    size_t lon_bins = grid.lon_bins();
+    size_t time_counter = axis.size();
+
+    if (time_counter * lat_bins * lon_bins > std::numeric_limits<uint32_t>::max())
+        throw std::runtime_error("Cube too large for 32-bit cell ids");
+
+    num_threads = resolve_loader_threads(num_threads);
+
+    std::cout << "Streaming simple cube: "
+              << time_counter << " × "
+              << lat_bins << " × "
+              << lon_bins << " using "
+              << num_threads << " threads\n";
+
+    SimpleCube<float> cube(time_counter, lat_bins, lon_bins);
+    SimpleCube<int> count(time_counter, lat_bins, lon_bins);
+    cube.fill(0.0f);
+    count.fill(0);
+
+    const size_t plane = lat_bins * lon_bins;
+
+    // ---- Decode + bin, one chunk at a time per worker ----
+    // Workers hit different chunks, which cover different hours most of
+    // the time, so relaxed atomic adds rarely contend
+    ZarrLoader::stream_chunks(
+        store_path, {"nsr", "lat", "lon"}, {"timestamps"},
+        [&](unsigned int, const ChunkBatch& batch)
+        {
+            const float* nsr = batch.floats[0];
+            const float* lat = batch.floats[1];
+            const float* lon = batch.floats[2];
+            const int32_t* hours = batch.hours[0];
+
+            uint32_t cell;
+            for (size_t i = 0; i < batch.count; ++i)
+            {
+                if (!cell_of(grid, axis, lat_bins, lon_bins,
+                             lat[i], lon[i], nsr[i], hours[i], cell))
+                    continue;
+
+                size_t t = cell / plane;
+                size_t la = (cell % plane) / lon_bins;
+                size_t lo = cell % lon_bins;
+
+                atomic_ops::fetch_add(cube.at(t, la, lo), nsr[i]);
+                atomic_ops::fetch_add(count.at(t, la, lo), 1);
+            }
+        },
+        num_threads,
+        stats);
+
+    // ---- Normalize ----
+#pragma omp parallel for schedule(static) num_threads(num_threads)
+    for (size_t t = 0; t < time_counter; ++t)
+    {
+        for (size_t la = 0; la < lat_bins; ++la)
+        {
+            for (size_t lo = 0; lo < lon_bins; ++lo)
+            {
+                int c = count.at(t, la, lo);
+                if (c > 0)
+                    cube.at(t, la, lo) /= c;
+            }
+        }
+    }
+
+    if (valid)
+        *valid = ValidityMask::from_counts(count);
+
+    return cube;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../cube/simple_cube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+#include "../loader/chunk_scheduler.h"
+#include <string>
+
+// Fused load-and-bin pipeline.
+// Each decoded chunk (same index across nsr/lat/lon/timestamps) is binned
+// straight into the cube and its buffers are reused for the next chunk, so
+// peak memory is the cube plus in-flight chunks, never the full arrays.
+class StreamingCubeBuilder {
+public:
+    // Two passes over the store: timestamps only for the time axis, then
+    // all four arrays for binning. valid, if given, receives the mask of
+    // cells with observations.
+    static SimpleCube<float> build(
+        const std::string& store_path,
+        unsigned int num_threads = 0,  // 0 = auto-detect
+        LoadStats* stats = nullptr,
+        ValidityMask* valid = nullptr
+    );
+
+    // Single pass with a known axis (e.g. from a previous scan)
+    static SimpleCube<float> build(
+        const std::string& store_path,
+        const TimeAxis& axis,
+        unsigned int num_threads = 0,  // 0 = auto-detect
+        LoadStats* stats = nullptr,
+        ValidityMask* valid = nullptr
+    );
+
+    // Compact time axis of the store, streaming only the timestamps
+    static TimeAxis scan_time_axis(
+        const std::string& store_path,
+        unsigned int num_threads = 0  // 0 = auto-detect
+    );
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+// Bounds checking is a debug-only policy: at() validates indices unless
+// NDEBUG is defined, so release OLAP loops pay no branch per element.
+#ifdef NDEBUG
+constexpr bool kCubeBoundsCheck = false;
+#else
+constexpr bool kCubeBoundsCheck = true;
+#endif
+
+constexpr std::size_t kCubeAlignment = 64;
+
+// Minimal allocator handing out cache-line aligned blocks, so every cube
+// plane starts on a 64-byte boundary and simd loads never split lines.
+template<typename T, std::size_t Align = kCubeAlignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template<typename U>
+    struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(
+            ::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, std::size_t) {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template<typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+
+    template<typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+// Storage engine shared by Datacube and SimpleCube.
+// One aligned buffer in (t, lat, lon) order with explicit strides:
+// element (t, lat, lon) lives at t * t_stride() + lat * lat_stride() + lon.
+// Inner loops should take row(t, lat) once and index it directly.
+template<typename Dtype>
+class CubeStorage {
+private:
+    std::size_t T_dim, LAT_dim, LON_dim;
+    std::vector<Dtype, AlignedAllocator<Dtype>> buffer;
+
+public:
+    using value_type = Dtype;
+
+    CubeStorage(std::size_t T, std::size_t LAT, std::size_t LON)
+        : T_dim(T), LAT_dim(LAT), LON_dim(LON), buffer(T * LAT * LON) {}
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+
+    std::size_t t_stride() const { return LAT_dim * LON_dim; }
+    std::size_t lat_stride() const { return LON_dim; }
+    std::size_t size() const { return buffer.size(); }
+
+    std::size_t offset(std::size_t t, std::size_t lat, std::size_t lon) const {
+        return t * t_stride() + lat * lat_stride() + lon;
+    }
+
+    Dtype& at(std::size_t t, std::size_t lat, std::size_t lon) {
+        check(t, lat, lon);
+        return buffer[offset(t, lat, lon)];
+    }
+
+    const Dtype& at(std::size_t t, std::size_t lat, std::size_t lon) const {
+        check(t, lat, lon);
+        return buffer[offset(t, lat, lon)];
+    }
+
+    // Contiguous lon row of (t, lat), lon_dim() elements
+    Dtype* row(std::size_t t, std::size_t lat) {
+        check_row(t, lat);
+        return buffer.data() + offset(t, lat, 0);
+    }
+
+    const Dtype* row(std::size_t t, std::size_t lat) const {
+        check_row(t, lat);
+        return buffer.data() + offset(t, lat, 0);
+    }
+
+    Dtype* data() { return buffer.data(); }
+    const Dtype* data() const { return buffer.data(); }
+
+    void fill(const Dtype& value) {
+        std::fill(buffer.begin(), buffer.end(), value);
+    }
+
+private:
+    void check(std::size_t t, std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim || lon >= LON_dim))
+            throw std::out_of_range("Index out of bounds");
+    }
+
+    void check_row(std::size_t t, std::size_t lat) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim))
+            throw std::out_of_range("Row out of bounds");
+    }
+};
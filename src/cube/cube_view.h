@@ -0,0 +1,89 @@
+#pragma once
+#include "cube_storage.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
+// Non-owning, read-only window onto a t-major cube.
+// A view is a base pointer, three extents and the t/lat strides of the
+// cube it was taken from (lon stride is always 1), so slicing and dicing
+// are O(1) and chain without copying. The source cube must outlive every
+// view of it; call materialize() to get an owning copy.
+template<typename Dtype>
+class CubeView {
+private:
+    const Dtype* base;
+    std::size_t T_dim, LAT_dim, LON_dim;
+    std::size_t t_step, lat_step;
+
+public:
+    using value_type = Dtype;
+
+    CubeView(const Dtype* data,
+             std::size_t T, std::size_t LAT, std::size_t LON,
+             std::size_t t_stride, std::size_t lat_stride)
+        : base(data), T_dim(T), LAT_dim(LAT), LON_dim(LON),
+          t_step(t_stride), lat_step(lat_stride) {}
+
+    // Whole-cube view
+    CubeView(const CubeStorage<Dtype>& cube)
+        : CubeView(cube.data(), cube.time_dim(), cube.lat_dim(), cube.lon_dim(),
+                   cube.t_stride(), cube.lat_stride()) {}
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+    std::size_t t_stride() const { return t_step; }
+    std::size_t lat_stride() const { return lat_step; }
+    std::size_t size() const { return T_dim * LAT_dim * LON_dim; }
+
+    // True when the view covers one gap-free block of memory
+    bool contiguous() const {
+        return (LAT_dim <= 1 || lat_step == LON_dim) &&
+               (T_dim <= 1 || t_step == LAT_dim * LON_dim);
+    }
+
+    const Dtype& at(std::size_t t, std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim || lon >= LON_dim))
+            throw std::out_of_range("Index out of bounds");
+        return base[t * t_step + lat * lat_step + lon];
+    }
+
+    // Contiguous lon row of (t, lat), lon_dim() elements
+    const Dtype* row(std::size_t t, std::size_t lat) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim))
+            throw std::out_of_range("Row out of bounds");
+        return base + t * t_step + lat * lat_step;
+    }
+
+    // Sub-view over [t_start, t_end) × [lat_start, lat_end) × [lon_start, lon_end)
+    CubeView sub(std::size_t t_start, std::size_t t_end,
+                 std::size_t lat_start, std::size_t lat_end,
+                 std::size_t lon_start, std::size_t lon_end) const
+    {
+        if (t_end > T_dim || lat_end > LAT_dim || lon_end > LON_dim ||
+            t_start > t_end || lat_start > lat_end || lon_start > lon_end)
+            throw std::out_of_range("View range out of bounds");
+
+        return CubeView(base + t_start * t_step + lat_start * lat_step + lon_start,
+                        t_end - t_start, lat_end - lat_start, lon_end - lon_start,
+                        t_step, lat_step);
+    }
+
+    // Owning row-major copy (SimpleCube, Datacube, ...)
+    template<typename Cube>
+    Cube materialize() const
+    {
+        Cube cube(T_dim, LAT_dim, LON_dim);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < T_dim; ++t)
+            for (std::size_t lat = 0; lat < LAT_dim; ++lat)
+            {
+                const Dtype* src = row(t, lat);
+                std::copy(src, src + LON_dim, cube.row(t, lat));
+            }
+
+        return cube;
+    }
+};
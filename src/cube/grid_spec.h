@@ -0,0 +1,37 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+
+// Regular lat/lon grid the observations are binned into.
+// Defaults cover India at 0.25°: 140 × 140 cells.
+struct GridSpec {
+    double lat_min = 5.0;
+    double lat_max = 40.0;
+    double lon_min = 65.0;
+    double lon_max = 100.0;
+    double resolution = 0.25;
+
+    size_t lat_bins() const {
+        return static_cast<size_t>(std::ceil((lat_max - lat_min) / resolution));
+    }
+
+    size_t lon_bins() const {
+        return static_cast<size_t>(std::ceil((lon_max - lon_min) / resolution));
+    }
+
+    // Grid cell of a point; false if it falls outside the grid.
+    // Points less than one cell below the minimum land in cell 0, as the
+    // builders have always truncated toward zero.
+    bool bin(float lat, float lon, size_t& lat_idx, size_t& lon_idx) const {
+        const double inv_res = 1.0 / resolution;
+        const double la = (lat - lat_min) * inv_res;
+        const double lo = (lon - lon_min) * inv_res;
+
+        if (!(la > -1.0) || !(lo > -1.0))
+            return false;
+
+        lat_idx = static_cast<size_t>(la);
+        lon_idx = static_cast<size_t>(lo);
+        return lat_idx < lat_bins() && lon_idx < lon_bins();
+    }
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include "simple_cube.h"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Per-cell measures a builder can accumulate next to the mean cube
+namespace measure {
+    constexpr unsigned sum = 1, count = 2, min = 4, max = 8, m2 = 16;
+    constexpr unsigned all = sum | count | min | max | m2;
+}
+
+// Multi-measure companion of a built cube: the requested subset of
+// sum, count, min, max and M2 (sum of squared deviations from the cell
+// mean) for every (t, lat, lon) cell, filled by the builders in the same
+// scatter pass as the mean. Variance and std come from M2 and count, so
+// any of them can be queried later without rebinning observations.
+// Cells without observations hold 0 in every measure.
+//
+//   MeasureCube measures(measure::max | measure::m2);
+//   auto mean = OMPSimpleCubeBuilder::build(lat, lon, nsr, hours, axis,
+//                                           0, nullptr, nullptr, &measures);
+//   auto sd = measures.std_dev();
+class MeasureCube {
+private:
+    unsigned requested = 0;
+
+public:
+    SimpleCube<float> sum{0, 0, 0};
+    SimpleCube<int> count{0, 0, 0};
+    SimpleCube<float> min{0, 0, 0};
+    SimpleCube<float> max{0, 0, 0};
+    SimpleCube<float> m2{0, 0, 0};
+
+    // measures: bitwise or of measure:: flags; m2 implies count so the
+    // variance can be finished
+    explicit MeasureCube(unsigned measures = measure::all)
+        : requested(measures & measure::all)
+    {
+        if (requested & measure::m2)
+            requested |= measure::count;
+    }
+
+    unsigned measures() const { return requested; }
+    bool has(unsigned m) const { return (requested & m) == m; }
+
+    // Allocates the requested measures for a builder, zeroed; min and max
+    // start at ±inf until finish() clears the empty cells
+    void reset(std::size_t T, std::size_t LAT, std::size_t LON)
+    {
+        auto alloc = [&](auto& cube, unsigned m) {
+            using Cube = std::decay_t<decltype(cube)>;
+            cube = has(m) ? Cube(T, LAT, LON) : Cube(0, 0, 0);
+        };
+
+        alloc(sum, measure::sum);
+        alloc(count, measure::count);
+        alloc(min, measure::min);
+        alloc(max, measure::max);
+        alloc(m2, measure::m2);
+
+        min.fill(std::numeric_limits<float>::infinity());
+        max.fill(-std::numeric_limits<float>::infinity());
+    }
+
+    // One observation v of flat cell i, given the cell's sum and count
+    // before v. Welford's update, with the running mean taken as
+    // sum / count so no extra mean cube is kept:
+    //   M2 += (v - mean_before) * (v - mean_after)
+    //       = (n v - sum_before)^2 / (n (n + 1)),  n = count_before
+    void add(std::size_t i, float v, float sum_before, int count_before)
+    {
+        if (has(measure::min) && v < min.data()[i]) min.data()[i] = v;
+        if (has(measure::max) && v > max.data()[i]) max.data()[i] = v;
+
+        if (has(measure::m2) && count_before > 0)
+        {
+            const float n = static_cast<float>(count_before);
+            const float d = n * v - sum_before;
+            m2.data()[i] += d * d / (n * (n + 1.0f));
+        }
+    }
+
+    // Cell i is complete with total sum over n observations
+    void finish(std::size_t i, float total, int n)
+    {
+        if (has(measure::sum)) sum.data()[i] = total;
+        if (has(measure::count)) count.data()[i] = n;
+
+        if (n == 0)
+        {
+            if (has(measure::min)) min.data()[i] = 0.0f;
+            if (has(measure::max)) max.data()[i] = 0.0f;
+        }
+    }
+
+    // M2 / count (population), or M2 / (count - 1) with sample set;
+    // 0 where there are too few observations
+    SimpleCube<float> variance(bool sample = false) const
+    {
+        if (!has(measure::m2))
+            throw std::logic_error("MeasureCube: variance needs the m2 measure");
+
+        SimpleCube<float> out(m2.time_dim(), m2.lat_dim(), m2.lon_dim());
+        const int ddof = sample ? 1 : 0;
+
+        for (std::size_t i = 0; i < out.size(); ++i)
+        {
+            const int n = count.data()[i] - ddof;
+            out.data()[i] = n > 0 ? m2.data()[i] / n : 0.0f;
+        }
+        return out;
+    }
+
+    SimpleCube<float> std_dev(bool sample = false) const
+    {
+        SimpleCube<float> out = variance(sample);
+        for (std::size_t i = 0; i < out.size(); ++i)
+            out.data()[i] = std::sqrt(out.data()[i]);
+        return out;
+    }
+};
@@ -0,0 +1,169 @@
+#pragma once
+#include "measure_cube.h"
+#include "simple_cube.h"
+#include "time_axis.h"
+#include "validity_mask.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Un-normalized aggregates of one shard of observations: per-cell sum
+// and count, optionally min, max and M2, on the shard's own time axis.
+// Shards built from disjoint inputs (months, granule ranges, processes)
+// combine exactly with merge(), which is associative and commutative up
+// to float rounding of the sums, and costs O(cells) instead of a rebuild.
+// finalize() turns the result into the usual mean cube.
+//
+//   MeasureCube june(measure::sum | measure::count);
+//   OMPSimpleCubeBuilder::build(lat, lon, nsr, hours, axis, 0, nullptr, nullptr, &june);
+//   PartialCube total = PartialCube::merge(PartialCube(axis, std::move(june)), july);
+//   SimpleCube<float> mean = total.finalize();
+class PartialCube {
+private:
+    TimeAxis axis_;
+    MeasureCube m;
+
+public:
+    static constexpr unsigned kRequired = measure::sum | measure::count;
+
+    PartialCube() : m(kRequired) { m.reset(0, 0, 0); }
+
+    // measures: as filled by a builder over axis; needs at least sum and count
+    PartialCube(TimeAxis axis, MeasureCube measures)
+        : axis_(std::move(axis)), m(std::move(measures))
+    {
+        if (!m.has(kRequired))
+            throw std::invalid_argument("PartialCube needs the sum and count measures");
+        if (m.sum.time_dim() != axis_.size())
+            throw std::invalid_argument("PartialCube: time axis does not match the measures");
+    }
+
+    const TimeAxis& axis() const { return axis_; }
+    const MeasureCube& measures() const { return m; }
+    bool has(unsigned measure) const { return m.has(measure); }
+
+    size_t time_dim() const { return m.sum.time_dim(); }
+    size_t lat_dim() const { return m.sum.lat_dim(); }
+    size_t lon_dim() const { return m.sum.lon_dim(); }
+
+    // Mean cube (sum / count, 0 where nothing was observed), as the
+    // builders return it; valid, if given, receives the observed cells
+    SimpleCube<float> finalize(ValidityMask* valid = nullptr) const
+    {
+        SimpleCube<float> mean(time_dim(), lat_dim(), lon_dim());
+        const float* s = m.sum.data();
+        const int* c = m.count.data();
+        float* out = mean.data();
+        const int64_t n = static_cast<int64_t>(mean.size());
+
+#pragma omp parallel for simd schedule(static)
+        for (int64_t i = 0; i < n; ++i)
+            out[i] = c[i] > 0 ? s[i] / c[i] : 0.0f;
+
+        if (valid)
+            *valid = ValidityMask::from_counts(m.count);
+        return mean;
+    }
+
+    // Union of both shards. The time axis is the union of their hours;
+    // an hour present in both combines cell by cell. The result keeps the
+    // measures both sides have (sum and count always).
+    static PartialCube merge(const PartialCube& a, const PartialCube& b)
+    {
+        if (a.time_dim() == 0) return b;
+        if (b.time_dim() == 0) return a;
+
+        if (a.lat_dim() != b.lat_dim() || a.lon_dim() != b.lon_dim())
+            throw std::invalid_argument("PartialCube::merge: shards are on different grids");
+
+        TimeAxis axis = a.axis_;
+        if (a.axis_ != b.axis_)
+        {
+            std::vector<int32_t> ha(a.time_dim()), hb(b.time_dim()), hours;
+            for (size_t t = 0; t < ha.size(); ++t) ha[t] = a.axis_.hour(t);
+            for (size_t t = 0; t < hb.size(); ++t) hb[t] = b.axis_.hour(t);
+
+            hours.reserve(ha.size() + hb.size());
+            std::set_union(ha.begin(), ha.end(), hb.begin(), hb.end(),
+                           std::back_inserter(hours));
+            axis = TimeAxis::from_sorted_hours(std::move(hours));
+        }
+
+        const size_t T = axis.size();
+        const size_t plane = a.lat_dim() * a.lon_dim();
+
+        MeasureCube out(a.m.measures() & b.m.measures());
+        out.reset(T, a.lat_dim(), a.lon_dim());
+
+        const bool keep_min = out.has(measure::min);
+        const bool keep_max = out.has(measure::max);
+        const bool keep_m2 = out.has(measure::m2);
+
+#pragma omp parallel for schedule(static)
+        for (int64_t t = 0; t < static_cast<int64_t>(T); ++t)
+        {
+            const int32_t hour = axis.hour(static_cast<size_t>(t));
+            const int32_t ta = a.axis_.index(hour);
+            const int32_t tb = b.axis_.index(hour);
+            const size_t base = static_cast<size_t>(t) * plane;
+
+            // One side only: copy its slice
+            if (ta < 0 || tb < 0)
+            {
+                const MeasureCube& src = ta < 0 ? b.m : a.m;
+                const size_t from = static_cast<size_t>(ta < 0 ? tb : ta) * plane;
+
+                std::copy_n(src.sum.data() + from, plane, out.sum.data() + base);
+                std::copy_n(src.count.data() + from, plane, out.count.data() + base);
+                if (keep_min) std::copy_n(src.min.data() + from, plane, out.min.data() + base);
+                if (keep_max) std::copy_n(src.max.data() + from, plane, out.max.data() + base);
+                if (keep_m2)  std::copy_n(src.m2.data() + from, plane, out.m2.data() + base);
+                continue;
+            }
+
+            const size_t ia0 = static_cast<size_t>(ta) * plane;
+            const size_t ib0 = static_cast<size_t>(tb) * plane;
+
+            for (size_t i = 0; i < plane; ++i)
+            {
+                const size_t ia = ia0 + i, ib = ib0 + i, o = base + i;
+                const int na = a.m.count.data()[ia];
+                const int nb = b.m.count.data()[ib];
+                const float sa = a.m.sum.data()[ia];
+                const float sb = b.m.sum.data()[ib];
+
+                out.sum.data()[o] = sa + sb;
+                out.count.data()[o] = na + nb;
+
+                // Empty cells hold 0 in min/max/M2, so take the other side
+                if (na == 0 || nb == 0)
+                {
+                    const MeasureCube& src = na == 0 ? b.m : a.m;
+                    const size_t is = na == 0 ? ib : ia;
+                    if (keep_min) out.min.data()[o] = src.min.data()[is];
+                    if (keep_max) out.max.data()[o] = src.max.data()[is];
+                    if (keep_m2)  out.m2.data()[o] = src.m2.data()[is];
+                    continue;
+                }
+
+                if (keep_min) out.min.data()[o] = std::min(a.m.min.data()[ia], b.m.min.data()[ib]);
+                if (keep_max) out.max.data()[o] = std::max(a.m.max.data()[ia], b.m.max.data()[ib]);
+
+                // Chan et al.: M2 = M2a + M2b + delta^2 na nb / (na + nb)
+                if (keep_m2)
+                {
+                    const float delta = sb / nb - sa / na;
+                    out.m2.data()[o] = a.m.m2.data()[ia] + b.m.m2.data()[ib] +
+                                       delta * delta * (static_cast<float>(na) * nb / (na + nb));
+                }
+            }
+        }
+
+        return PartialCube(std::move(axis), std::move(out));
+    }
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include "cube_storage.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Pixel-major (lat, lon, t) copy of a cube.
+// The full hourly series of one pixel is contiguous, so drill-down and
+// time-axis reductions read T consecutive values instead of T values
+// LAT × LON apart. Built once from a t-major cube and read-only after that.
+template<typename Dtype>
+class PixelMajorCube {
+private:
+    std::size_t T_dim, LAT_dim, LON_dim;
+    std::vector<Dtype, AlignedAllocator<Dtype>> buffer;
+
+public:
+    using value_type = Dtype;
+
+    PixelMajorCube(std::size_t T, std::size_t LAT, std::size_t LON)
+        : T_dim(T), LAT_dim(LAT), LON_dim(LON), buffer(T * LAT * LON) {}
+
+    // Parallel cache-blocked transpose of a t-major cube or view.
+    // Each block reads `block` hours of a few lat rows and writes the
+    // matching `block`-hour runs of those pixels' series, so both sides
+    // stay within a few KiB.
+    template<typename Cube>
+    static PixelMajorCube from_cube(const Cube& cube,
+                                    std::size_t block = 64)
+    {
+        if (block == 0)
+            throw std::invalid_argument("Transpose block must be positive");
+
+        const std::size_t T = cube.time_dim();
+        const std::size_t LAT = cube.lat_dim();
+        const std::size_t LON = cube.lon_dim();
+
+        PixelMajorCube pm(T, LAT, LON);
+        Dtype* dst = pm.buffer.data();
+
+        // Lat rows per block: about `block` pixels, at least one row
+        const std::size_t rows = std::max<std::size_t>(1, block / std::max<std::size_t>(1, LON));
+
+        const std::size_t blocks_t = (T + block - 1) / block;
+        const std::size_t blocks_lat = (LAT + rows - 1) / rows;
+
+#pragma omp parallel for collapse(2) schedule(static)
+        for (std::size_t bl = 0; bl < blocks_lat; ++bl)
+        {
+            for (std::size_t bt = 0; bt < blocks_t; ++bt)
+            {
+                const std::size_t l0 = bl * rows, l1 = std::min(LAT, l0 + rows);
+                const std::size_t t0 = bt * block, t1 = std::min(T, t0 + block);
+
+                for (std::size_t lat = l0; lat < l1; ++lat)
+                    for (std::size_t t = t0; t < t1; ++t)
+                    {
+                        const Dtype* src = cube.row(t, lat);
+                        Dtype* out = dst + lat * LON * T + t;
+
+                        for (std::size_t lon = 0; lon < LON; ++lon)
+                            out[lon * T] = src[lon];
+                    }
+            }
+        }
+
+        return pm;
+    }
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+    std::size_t size() const { return buffer.size(); }
+
+    // Contiguous hourly series of pixel (lat, lon), time_dim() elements
+    const Dtype* series(std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && (lat >= LAT_dim || lon >= LON_dim))
+            throw std::out_of_range("Pixel out of bounds");
+        return buffer.data() + (lat * LON_dim + lon) * T_dim;
+    }
+
+    const Dtype& at(std::size_t t, std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && t >= T_dim)
+            throw std::out_of_range("Index out of bounds");
+        return series(lat, lon)[t];
+    }
+
+    const Dtype* data() const { return buffer.data(); }
+};
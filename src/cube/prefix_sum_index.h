@@ -0,0 +1,200 @@
+#pragma once
+#include "cube_storage.h"
+#include "validity_mask.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Half-open (t, lat, lon) box
+struct CubeBox {
+    std::size_t t_start, t_end;
+    std::size_t lat_start, lat_end;
+    std::size_t lon_start, lon_end;
+
+    bool empty() const {
+        return t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start;
+    }
+
+    std::size_t volume() const {
+        return empty() ? 0 : (t_end - t_start) * (lat_end - lat_start) * (lon_end - lon_start);
+    }
+};
+
+// 3D summed-area table of a cube: P[t][lat][lon] is the sum of every cell
+// strictly before (t, lat, lon) on all three axes, so any box sum is eight
+// lookups by inclusion-exclusion. Sums are kept in double: box sums are
+// differences of large prefixes and would cancel badly in float. Built
+// with a validity mask it also keeps observed-cell counts, and box means
+// average observed cells only, like the masked omp_olap kernels.
+//
+// Tables are (T+1) × (LAT+1) × (LON+1) with a zero border, so lookups have
+// no edge cases. Memory is 8 bytes per cell (12 with counts).
+class PrefixSumIndex {
+private:
+    std::size_t T_dim = 0, LAT_dim = 0, LON_dim = 0;
+    std::vector<double, AlignedAllocator<double>> sum;
+    std::vector<uint32_t, AlignedAllocator<uint32_t>> count;   // empty unless masked
+
+    std::size_t idx(std::size_t t, std::size_t lat, std::size_t lon) const {
+        return (t * (LAT_dim + 1) + lat) * (LON_dim + 1) + lon;
+    }
+
+    // Turn per-cell values into prefixes one axis at a time; each pass is
+    // parallel across the lines it runs along
+    template<typename V>
+    void prefix(std::vector<V, AlignedAllocator<V>>& p) const
+    {
+        const std::size_t T1 = T_dim + 1, LAT1 = LAT_dim + 1, LON1 = LON_dim + 1;
+        const std::size_t plane = LAT1 * LON1;
+        V* a = p.data();
+
+        // lon: running sum along every row
+#pragma omp parallel for schedule(static)
+        for (std::size_t r = 0; r < T1 * LAT1; ++r)
+        {
+            V* row = a + r * LON1;
+            for (std::size_t lon = 1; lon < LON1; ++lon)
+                row[lon] += row[lon - 1];
+        }
+
+        // lat: add the previous row, a contiguous simd loop
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < T1; ++t)
+            for (std::size_t lat = 1; lat < LAT1; ++lat)
+            {
+                V* row = a + t * plane + lat * LON1;
+                const V* prev = row - LON1;
+
+#pragma omp simd
+                for (std::size_t lon = 0; lon < LON1; ++lon)
+                    row[lon] += prev[lon];
+            }
+
+        // t: add the previous plane, parallel across the plane
+        for (std::size_t t = 1; t < T1; ++t)
+        {
+            V* cur = a + t * plane;
+            const V* prev = cur - plane;
+
+#pragma omp parallel for simd schedule(static)
+            for (std::size_t i = 0; i < plane; ++i)
+                cur[i] += prev[i];
+        }
+    }
+
+    template<typename V>
+    static V corners(const V* p, std::size_t t0, std::size_t t1,
+                     std::size_t a0, std::size_t a1,
+                     std::size_t o0, std::size_t o1,
+                     std::size_t LAT1, std::size_t LON1)
+    {
+        auto at = [&](std::size_t t, std::size_t a, std::size_t o) {
+            return p[(t * LAT1 + a) * LON1 + o];
+        };
+
+        return  at(t1, a1, o1) - at(t0, a1, o1) - at(t1, a0, o1) - at(t1, a1, o0)
+              + at(t0, a0, o1) + at(t0, a1, o0) + at(t1, a0, o0) - at(t0, a0, o0);
+    }
+
+public:
+    PrefixSumIndex() = default;
+
+    // Build from a t-major cube or view; valid (optional) adds counts
+    template<typename Cube>
+    static PrefixSumIndex build(const Cube& cube, const ValidityMask* valid = nullptr)
+    {
+        if (valid && !valid->matches(cube))
+            throw std::invalid_argument("Validity mask does not match cube dimensions");
+
+        PrefixSumIndex index;
+        index.T_dim = cube.time_dim();
+        index.LAT_dim = cube.lat_dim();
+        index.LON_dim = cube.lon_dim();
+
+        const std::size_t T = index.T_dim, LAT = index.LAT_dim, LON = index.LON_dim;
+        const std::size_t cells = (T + 1) * (LAT + 1) * (LON + 1);
+
+        if (valid && T * LAT * LON > std::numeric_limits<uint32_t>::max())
+            throw std::runtime_error("Cube too large for 32-bit prefix counts");
+
+        index.sum.assign(cells, 0.0);
+        if (valid)
+            index.count.assign(cells, 0);
+
+        // Scatter cells into the interior, shifted by one on every axis
+#pragma omp parallel for collapse(2) schedule(static)
+        for (std::size_t t = 0; t < T; ++t)
+            for (std::size_t lat = 0; lat < LAT; ++lat)
+            {
+                const auto* src = cube.row(t, lat);
+                double* dst = index.sum.data() + index.idx(t + 1, lat + 1, 1);
+
+                for (std::size_t lon = 0; lon < LON; ++lon)
+                    dst[lon] = src[lon];
+
+                if (valid)
+                {
+                    uint32_t* c = index.count.data() + index.idx(t + 1, lat + 1, 1);
+                    for (std::size_t lon = 0; lon < LON; ++lon)
+                        c[lon] = valid->test(t, lat, lon);
+                }
+            }
+
+        index.prefix(index.sum);
+        if (valid)
+            index.prefix(index.count);
+
+        return index;
+    }
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+
+    // Throws std::out_of_range unless the box lies inside the cube
+    void check(const CubeBox& box) const {
+        if (box.t_end > T_dim || box.lat_end > LAT_dim || box.lon_end > LON_dim)
+            throw std::out_of_range("Box out of bounds");
+    }
+
+    // Counts observed cells (built with a validity mask)
+    bool has_count() const { return !count.empty(); }
+
+    std::size_t bytes() const {
+        return sum.size() * sizeof(double) + count.size() * sizeof(uint32_t);
+    }
+
+    double box_sum(const CubeBox& box) const
+    {
+        check(box);
+        if (box.empty())
+            return 0.0;
+
+        return corners(sum.data(), box.t_start, box.t_end,
+                       box.lat_start, box.lat_end, box.lon_start, box.lon_end,
+                       LAT_dim + 1, LON_dim + 1);
+    }
+
+    // Observed cells in the box with counts, otherwise its volume
+    std::size_t box_count(const CubeBox& box) const
+    {
+        check(box);
+        if (box.empty())
+            return 0;
+        if (!has_count())
+            return box.volume();
+
+        return corners(count.data(), box.t_start, box.t_end,
+                       box.lat_start, box.lat_end, box.lon_start, box.lon_end,
+                       LAT_dim + 1, LON_dim + 1);
+    }
+
+    // 0 for an empty box or one with no observed cells
+    double box_mean(const CubeBox& box) const
+    {
+        const std::size_t n = box_count(box);
+        return n ? box_sum(box) / static_cast<double>(n) : 0.0;
+    }
+};
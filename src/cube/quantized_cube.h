@@ -0,0 +1,292 @@
+#pragma once
+#include "cube_storage.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+// IEEE half-precision conversions. With F16C (-mf16c) these are single
+// vcvtph2ps / vcvtps2ph instructions, 8 lanes at a time in the bulk
+// helpers; otherwise a portable bit-level path with round-to-nearest-even.
+namespace half {
+
+inline uint16_t from_float(float f)
+{
+#if defined(__F16C__)
+    return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+
+    const uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000u);
+    const uint32_t mag = x & 0x7fffffffu;
+
+    if (mag > 0x7f800000u)                 // NaN
+        return sign | 0x7e00u;
+    if (mag >= 0x47800000u)                // >= 65536 and inf
+        return sign | 0x7c00u;
+
+    if (mag < 0x38800000u)                 // below 2^-14: subnormal or zero
+    {
+        float a;
+        std::memcpy(&a, &mag, sizeof(a));
+        return sign | static_cast<uint16_t>(std::nearbyint(a * 16777216.0f));
+    }
+
+    // Rebias the exponent (127 -> 15) and round the dropped 13 bits to even;
+    // a carry out of the mantissa correctly bumps the exponent (or to inf)
+    uint32_t h = (mag - 0x38000000u) >> 13;
+    const uint32_t rest = mag & 0x1fffu;
+    if (rest > 0x1000u || (rest == 0x1000u && (h & 1u)))
+        ++h;
+
+    return sign | static_cast<uint16_t>(h);
+#endif
+}
+
+inline float to_float(uint16_t h)
+{
+#if defined(__F16C__)
+    return _cvtsh_ss(h);
+#else
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+    const uint32_t exp = (h >> 10) & 0x1fu;
+    const uint32_t man = h & 0x3ffu;
+
+    if (exp == 0)                          // subnormal or zero: man × 2^-24
+        return sign ? -std::ldexp(static_cast<float>(man), -24)
+                    :  std::ldexp(static_cast<float>(man), -24);
+
+    uint32_t x = (exp == 0x1fu)
+               ? sign | 0x7f800000u | (man << 13)
+               : sign | ((exp + 112u) << 23) | (man << 13);
+
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+#endif
+}
+
+inline void widen(const uint16_t* src, float* dst, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+#endif
+    for (; i < n; ++i)
+        dst[i] = to_float(src[i]);
+}
+
+inline void narrow(const float* src, uint16_t* dst, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i),
+            _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; i < n; ++i)
+        dst[i] = from_float(src[i]);
+}
+
+// acc[i] += src[i] widened, without staging a float row
+inline void accumulate(const uint16_t* src, float* acc, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i),
+            _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)))));
+#endif
+    for (; i < n; ++i)
+        acc[i] += to_float(src[i]);
+}
+
+// Sum of n widened values, 8 float lanes wide with F16C
+inline float sum(const uint16_t* src, std::size_t n)
+{
+    float total = 0.0f;
+    std::size_t i = 0;
+#if defined(__F16C__)
+    __m256 lanes = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8)
+        lanes = _mm256_add_ps(lanes,
+            _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+
+    alignas(32) float part[8];
+    _mm256_store_ps(part, lanes);
+    for (float p : part)
+        total += p;
+#endif
+    for (; i < n; ++i)
+        total += to_float(src[i]);
+    return total;
+}
+
+} // namespace half
+
+// 16-bit encodings of a float cube
+enum class QuantFormat {
+    Half,         // IEEE fp16: ~3 significant digits, relative error <= 2^-11
+    ScaledInt16   // value = code × scale + offset: uniform absolute error <= scale / 2
+};
+
+inline const char* quant_format_name(QuantFormat format)
+{
+    return format == QuantFormat::Half ? "fp16" : "int16";
+}
+
+// (t, lat, lon) float cube held as 16-bit codes in the shared aligned
+// storage engine: half the memory and half the bandwidth of SimpleCube<float>.
+// The format is picked when the cube is built; quant_olap kernels widen
+// codes to float (or accumulate scaled codes as integers) in registers.
+class QuantizedCube {
+private:
+    CubeStorage<uint16_t> codes;
+    QuantFormat fmt;
+    float scale_;
+    float offset_;
+
+public:
+    using value_type = float;
+
+    QuantizedCube(std::size_t T, std::size_t LAT, std::size_t LON,
+                  QuantFormat format, float scale = 1.0f, float offset = 0.0f)
+        : codes(T, LAT, LON), fmt(format), scale_(scale), offset_(offset)
+    {
+        if (!(scale > 0.0f))
+            throw std::invalid_argument("Quantization scale must be positive");
+    }
+
+    // Encode a float cube or view. ScaledInt16 uses offset 0 (zero stays
+    // exact, as most rainfall cells are zero) and a scale that maps the
+    // largest magnitude to ±32767.
+    template<typename Cube>
+    static QuantizedCube from_cube(const Cube& cube, QuantFormat format)
+    {
+        const std::size_t T = cube.time_dim();
+        const std::size_t LAT = cube.lat_dim();
+        const std::size_t LON = cube.lon_dim();
+
+        float scale = 1.0f;
+
+        if (format == QuantFormat::ScaledInt16)
+        {
+            float max_abs = 0.0f;
+
+#pragma omp parallel for reduction(max:max_abs) schedule(static)
+            for (std::size_t t = 0; t < T; ++t)
+                for (std::size_t lat = 0; lat < LAT; ++lat)
+                {
+                    const float* src = cube.row(t, lat);
+                    for (std::size_t lon = 0; lon < LON; ++lon)
+                        max_abs = std::max(max_abs, std::fabs(src[lon]));
+                }
+
+            if (max_abs > 0.0f)
+                scale = max_abs / 32767.0f;
+        }
+
+        QuantizedCube q(T, LAT, LON, format, scale);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < T; ++t)
+            for (std::size_t lat = 0; lat < LAT; ++lat)
+                q.encode_row(t, lat, cube.row(t, lat));
+
+        return q;
+    }
+
+    // Decoded float copy (SimpleCube, Datacube, ...)
+    template<typename Cube>
+    Cube to_cube() const
+    {
+        Cube cube(time_dim(), lat_dim(), lon_dim());
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < time_dim(); ++t)
+            for (std::size_t lat = 0; lat < lat_dim(); ++lat)
+                widen_row(t, lat, 0, lon_dim(), cube.row(t, lat));
+
+        return cube;
+    }
+
+    std::size_t time_dim() const { return codes.time_dim(); }
+    std::size_t lat_dim() const { return codes.lat_dim(); }
+    std::size_t lon_dim() const { return codes.lon_dim(); }
+    std::size_t size() const { return codes.size(); }
+    std::size_t bytes() const { return codes.size() * sizeof(uint16_t); }
+
+    QuantFormat format() const { return fmt; }
+    float scale() const { return scale_; }
+    float offset() const { return offset_; }
+
+    // Raw codes of row (t, lat); ScaledInt16 codes are int16 bit patterns
+    const uint16_t* code_row(std::size_t t, std::size_t lat) const { return codes.row(t, lat); }
+    uint16_t* code_row(std::size_t t, std::size_t lat) { return codes.row(t, lat); }
+
+    const int16_t* int_row(std::size_t t, std::size_t lat) const {
+        return reinterpret_cast<const int16_t*>(codes.row(t, lat));
+    }
+
+    uint16_t encode(float v) const {
+        if (fmt == QuantFormat::Half)
+            return half::from_float(v);
+
+        float q = std::nearbyint((v - offset_) / scale_);
+        q = std::min(32767.0f, std::max(-32768.0f, q));
+        return static_cast<uint16_t>(static_cast<int16_t>(q));
+    }
+
+    float decode(uint16_t code) const {
+        if (fmt == QuantFormat::Half)
+            return half::to_float(code);
+        return static_cast<int16_t>(code) * scale_ + offset_;
+    }
+
+    float at(std::size_t t, std::size_t lat, std::size_t lon) const {
+        return decode(codes.at(t, lat, lon));
+    }
+
+    // Encode LON floats into row (t, lat)
+    void encode_row(std::size_t t, std::size_t lat, const float* src)
+    {
+        uint16_t* dst = codes.row(t, lat);
+        const std::size_t LON = lon_dim();
+
+        if (fmt == QuantFormat::Half)
+        {
+            half::narrow(src, dst, LON);
+            return;
+        }
+
+        for (std::size_t lon = 0; lon < LON; ++lon)
+            dst[lon] = encode(src[lon]);
+    }
+
+    // Decode n cells of row (t, lat) starting at lon_start into out
+    void widen_row(std::size_t t, std::size_t lat,
+                   std::size_t lon_start, std::size_t n, float* out) const
+    {
+        if (fmt == QuantFormat::Half)
+        {
+            half::widen(code_row(t, lat) + lon_start, out, n);
+            return;
+        }
+
+        const int16_t* src = int_row(t, lat) + lon_start;
+        const float s = scale_, o = offset_;
+
+#pragma omp simd
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = src[i] * s + o;
+    }
+};
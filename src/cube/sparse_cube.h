@@ -0,0 +1,177 @@
+#pragma once
+#include "cube_storage.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Compressed (t, lat, lon) cube holding only non-zero cells.
+// Every (t, lat) row is one CSR row: row_start[t × LAT + lat] indexes the
+// first stored cell, lon_index/values hold the cells in ascending lon.
+// Memory is 6 bytes per non-zero cell (float) plus one offset per row, and
+// kernels walk the stored cells only, so both scale with non-zeros rather
+// than with T × LAT × LON. Absent cells read as zero.
+template<typename Dtype>
+class SparseCube {
+public:
+    using value_type = Dtype;
+    using index_type = uint16_t;
+
+private:
+    std::size_t T_dim, LAT_dim, LON_dim;
+    std::vector<std::size_t> row_start;   // T × LAT + 1 entries
+    std::vector<index_type> lon_index;    // nnz entries
+    std::vector<Dtype> values;            // nnz entries
+
+public:
+    // Adopt prebuilt CSR arrays (e.g. emitted by a cube builder)
+    SparseCube(std::size_t T, std::size_t LAT, std::size_t LON,
+               std::vector<std::size_t> starts,
+               std::vector<index_type> lons,
+               std::vector<Dtype> vals)
+        : T_dim(T), LAT_dim(LAT), LON_dim(LON),
+          row_start(std::move(starts)),
+          lon_index(std::move(lons)),
+          values(std::move(vals))
+    {
+        if (LON > std::numeric_limits<index_type>::max())
+            throw std::invalid_argument("Longitude dimension too large for sparse cube");
+        if (row_start.size() != T * LAT + 1 ||
+            lon_index.size() != values.size() ||
+            row_start.back() != values.size())
+            throw std::invalid_argument("Inconsistent sparse cube arrays");
+    }
+
+    // Empty (all-zero) cube
+    SparseCube(std::size_t T, std::size_t LAT, std::size_t LON)
+        : SparseCube(T, LAT, LON,
+                     std::vector<std::size_t>(T * LAT + 1, 0), {}, {}) {}
+
+    // Compress a dense t-major cube or view: one parallel pass counts the
+    // non-zeros of each row, a second fills them at their prefix offsets
+    template<typename Cube>
+    static SparseCube from_cube(const Cube& cube)
+    {
+        const std::size_t T = cube.time_dim();
+        const std::size_t LAT = cube.lat_dim();
+        const std::size_t LON = cube.lon_dim();
+        const std::size_t rows = T * LAT;
+
+        if (LON > std::numeric_limits<index_type>::max())
+            throw std::invalid_argument("Longitude dimension too large for sparse cube");
+
+        std::vector<std::size_t> starts(rows + 1, 0);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const Dtype* src = cube.row(r / LAT, r % LAT);
+            std::size_t n = 0;
+
+            for (std::size_t lon = 0; lon < LON; ++lon)
+                n += (src[lon] != 0);
+
+            starts[r + 1] = n;
+        }
+
+        for (std::size_t r = 0; r < rows; ++r)
+            starts[r + 1] += starts[r];
+
+        std::vector<index_type> lons(starts[rows]);
+        std::vector<Dtype> vals(starts[rows]);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const Dtype* src = cube.row(r / LAT, r % LAT);
+            std::size_t k = starts[r];
+
+            for (std::size_t lon = 0; lon < LON; ++lon)
+            {
+                if (src[lon] != 0)
+                {
+                    lons[k] = static_cast<index_type>(lon);
+                    vals[k] = src[lon];
+                    ++k;
+                }
+            }
+        }
+
+        return SparseCube(T, LAT, LON,
+                          std::move(starts), std::move(lons), std::move(vals));
+    }
+
+    // Dense copy (SimpleCube, Datacube, ...)
+    template<typename Cube>
+    Cube to_cube() const
+    {
+        Cube cube(T_dim, LAT_dim, LON_dim);
+        cube.fill(0);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < T_dim; ++t)
+            for (std::size_t lat = 0; lat < LAT_dim; ++lat)
+            {
+                Dtype* dst = cube.row(t, lat);
+                for (std::size_t k = row_begin(t, lat); k < row_end(t, lat); ++k)
+                    dst[lon_index[k]] = values[k];
+            }
+
+        return cube;
+    }
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+    std::size_t size() const { return T_dim * LAT_dim * LON_dim; }
+
+    // Stored (non-zero) cells
+    std::size_t nnz() const { return values.size(); }
+
+    double density() const {
+        return size() ? static_cast<double>(nnz()) / size() : 0.0;
+    }
+
+    // Resident bytes of the CSR arrays
+    std::size_t bytes() const {
+        return row_start.size() * sizeof(std::size_t) +
+               lon_index.size() * sizeof(index_type) +
+               values.size() * sizeof(Dtype);
+    }
+
+    // Stored cells of row (t, lat) are [row_begin, row_end)
+    std::size_t row_begin(std::size_t t, std::size_t lat) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim))
+            throw std::out_of_range("Row out of bounds");
+        return row_start[t * LAT_dim + lat];
+    }
+
+    std::size_t row_end(std::size_t t, std::size_t lat) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim))
+            throw std::out_of_range("Row out of bounds");
+        return row_start[t * LAT_dim + lat + 1];
+    }
+
+    // First stored cell of row (t, lat) with lon >= lon
+    std::size_t lower_bound(std::size_t t, std::size_t lat, std::size_t lon) const {
+        const index_type* first = lon_index.data() + row_begin(t, lat);
+        const index_type* last = lon_index.data() + row_end(t, lat);
+        return std::lower_bound(first, last, lon,
+                                [](index_type a, std::size_t b) { return a < b; })
+             - lon_index.data();
+    }
+
+    const index_type* lon_indices() const { return lon_index.data(); }
+    const Dtype* data() const { return values.data(); }
+
+    // Cell value; binary search within the row, zero if not stored
+    Dtype at(std::size_t t, std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && lon >= LON_dim)
+            throw std::out_of_range("Index out of bounds");
+        std::size_t k = lower_bound(t, lat, lon);
+        return (k < row_end(t, lat) && lon_index[k] == lon) ? values[k] : Dtype(0);
+    }
+};
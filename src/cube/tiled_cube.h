@@ -0,0 +1,188 @@
+#pragma once
+#include "cube_storage.h"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Tile extent along (t, lat, lon). The default 24×16×16 float tile is
+// 24 KiB: a day of hours over a 4°×4° patch, with 64-byte lon rows.
+struct TileShape {
+    std::size_t t = 24;
+    std::size_t lat = 16;
+    std::size_t lon = 16;
+
+    std::size_t plane() const { return lat * lon; }
+    std::size_t volume() const { return t * lat * lon; }
+};
+
+// Chunked (t, lat, lon) cube.
+// The cube is cut into fixed-size tiles stored one after another in
+// (tile_t, tile_lat, tile_lon) order; inside a tile cells are (t, lat, lon)
+// row-major. Edge tiles are padded to full size and the padding stays zero.
+// A time reduction over one spatial tile reads tile.t planes of
+// tile.lat × tile.lon contiguous cells, and a t-slice touches one plane per
+// tile, so both access patterns stream whole cache lines.
+template<typename Dtype>
+class TiledCube {
+private:
+    std::size_t T_dim, LAT_dim, LON_dim;
+    TileShape shape;
+    std::size_t tiles_t, tiles_lat, tiles_lon;
+    std::vector<Dtype, AlignedAllocator<Dtype>> buffer;
+
+public:
+    using value_type = Dtype;
+
+    TiledCube(std::size_t T, std::size_t LAT, std::size_t LON,
+              TileShape tile = TileShape())
+        : T_dim(T), LAT_dim(LAT), LON_dim(LON), shape(tile)
+    {
+        if (shape.t == 0 || shape.lat == 0 || shape.lon == 0)
+            throw std::invalid_argument("Tile extents must be positive");
+
+        tiles_t = (T + shape.t - 1) / shape.t;
+        tiles_lat = (LAT + shape.lat - 1) / shape.lat;
+        tiles_lon = (LON + shape.lon - 1) / shape.lon;
+        buffer.resize(tiles_t * tiles_lat * tiles_lon * shape.volume());
+    }
+
+    // Re-tile a row-major cube or view, parallel over t
+    template<typename Cube>
+    static TiledCube from_cube(const Cube& cube,
+                               TileShape tile = TileShape())
+    {
+        TiledCube tiled(cube.time_dim(), cube.lat_dim(), cube.lon_dim(), tile);
+        const std::size_t LAT = cube.lat_dim();
+        const std::size_t LON = cube.lon_dim();
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < cube.time_dim(); ++t)
+            for (std::size_t lat = 0; lat < LAT; ++lat)
+                tiled.write_row(t, lat, 0, LON, cube.row(t, lat));
+
+        return tiled;
+    }
+
+    // Copy back into a row-major cube type (SimpleCube, Datacube)
+    template<typename Cube>
+    Cube to_cube() const
+    {
+        Cube cube(T_dim, LAT_dim, LON_dim);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < T_dim; ++t)
+            for (std::size_t lat = 0; lat < LAT_dim; ++lat)
+                read_row(t, lat, 0, LON_dim, cube.row(t, lat));
+
+        return cube;
+    }
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+
+    const TileShape& tile_shape() const { return shape; }
+    std::size_t tiles_time() const { return tiles_t; }
+    std::size_t tiles_lat_dim() const { return tiles_lat; }
+    std::size_t tiles_lon_dim() const { return tiles_lon; }
+
+    // First cell of tile (bt, bl, bo)
+    Dtype* tile(std::size_t bt, std::size_t bl, std::size_t bo) {
+        return buffer.data() + tile_offset(bt, bl, bo);
+    }
+
+    const Dtype* tile(std::size_t bt, std::size_t bl, std::size_t bo) const {
+        return buffer.data() + tile_offset(bt, bl, bo);
+    }
+
+    // Valid (unpadded) extent of tile index b along each axis
+    std::size_t tile_t_extent(std::size_t bt) const {
+        return std::min(shape.t, T_dim - bt * shape.t);
+    }
+    std::size_t tile_lat_extent(std::size_t bl) const {
+        return std::min(shape.lat, LAT_dim - bl * shape.lat);
+    }
+    std::size_t tile_lon_extent(std::size_t bo) const {
+        return std::min(shape.lon, LON_dim - bo * shape.lon);
+    }
+
+    // Whole tile buffer, padding included (padding must stay zero)
+    Dtype* data() { return buffer.data(); }
+    const Dtype* data() const { return buffer.data(); }
+    std::size_t storage_size() const { return buffer.size(); }
+
+    Dtype& at(std::size_t t, std::size_t lat, std::size_t lon) {
+        check(t, lat, lon);
+        return buffer[offset(t, lat, lon)];
+    }
+
+    const Dtype& at(std::size_t t, std::size_t lat, std::size_t lon) const {
+        check(t, lat, lon);
+        return buffer[offset(t, lat, lon)];
+    }
+
+    // Copy cells [lon_start, lon_start + n) of row (t, lat) into dst,
+    // one contiguous tile row segment at a time
+    void read_row(std::size_t t, std::size_t lat,
+                  std::size_t lon_start, std::size_t n, Dtype* dst) const
+    {
+        for_row_segments(t, lat, lon_start, n,
+            [&](std::size_t off, std::size_t done, std::size_t len) {
+                std::copy(buffer.data() + off, buffer.data() + off + len, dst + done);
+            });
+    }
+
+    void write_row(std::size_t t, std::size_t lat,
+                   std::size_t lon_start, std::size_t n, const Dtype* src)
+    {
+        for_row_segments(t, lat, lon_start, n,
+            [&](std::size_t off, std::size_t done, std::size_t len) {
+                std::copy(src + done, src + done + len, buffer.data() + off);
+            });
+    }
+
+    // Sets every cell inside the cube; tile padding stays zero
+    void fill(const Dtype& value) {
+        std::vector<Dtype> row(LON_dim, value);
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t t = 0; t < T_dim; ++t)
+            for (std::size_t lat = 0; lat < LAT_dim; ++lat)
+                write_row(t, lat, 0, LON_dim, row.data());
+    }
+
+private:
+    std::size_t tile_offset(std::size_t bt, std::size_t bl, std::size_t bo) const {
+        return ((bt * tiles_lat + bl) * tiles_lon + bo) * shape.volume();
+    }
+
+    std::size_t offset(std::size_t t, std::size_t lat, std::size_t lon) const {
+        return tile_offset(t / shape.t, lat / shape.lat, lon / shape.lon)
+             + ((t % shape.t) * shape.lat + lat % shape.lat) * shape.lon
+             + lon % shape.lon;
+    }
+
+    template<typename Fn>
+    void for_row_segments(std::size_t t, std::size_t lat,
+                          std::size_t lon_start, std::size_t n, Fn&& fn) const
+    {
+        if (n == 0)
+            return;
+
+        check(t, lat, lon_start + n - 1);
+
+        std::size_t done = 0;
+        while (done < n) {
+            std::size_t lon = lon_start + done;
+            std::size_t len = std::min(n - done, shape.lon - lon % shape.lon);
+            fn(offset(t, lat, lon), done, len);
+            done += len;
+        }
+    }
+
+    void check(std::size_t t, std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim || lon >= LON_dim))
+            throw std::out_of_range("Index out of bounds");
+    }
+};
@@ -0,0 +1,139 @@
+#pragma once
+#include "../utils/time_utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Chronological hourly time axis shared by all cube builders.
+// t = hour - min_hour, or, when compacted, the rank of the hour among the
+// hours that actually hold observations. Either way t grows with time, so
+// time ranges map to index ranges with plain integer arithmetic.
+class TimeAxis {
+private:
+    int32_t min_hour_ = 0;
+    size_t span_ = 0;                  // max_hour - min_hour + 1
+    bool compact_ = false;
+    std::vector<int32_t> remap_;       // hour - min_hour -> t, -1 if empty (compact only)
+    std::vector<int32_t> hours_;       // t -> hour (compact only)
+
+public:
+    TimeAxis() = default;
+
+    // Contiguous axis over [min_hour, min_hour + span)
+    TimeAxis(int32_t min_hour, size_t span)
+        : min_hour_(min_hour), span_(span) {}
+
+    // Compact axis over an ascending list of distinct hours
+    static TimeAxis from_sorted_hours(std::vector<int32_t> hours)
+    {
+        TimeAxis axis;
+        if (hours.empty())
+            return axis;
+
+        axis.min_hour_ = hours.front();
+        axis.span_ = static_cast<size_t>(hours.back() - hours.front()) + 1;
+        axis.compact_ = true;
+        axis.remap_.assign(axis.span_, -1);
+
+        for (size_t t = 0; t < hours.size(); ++t)
+            axis.remap_[hours[t] - axis.min_hour_] = static_cast<int32_t>(t);
+
+        axis.hours_ = std::move(hours);
+        return axis;
+    }
+
+    // One parallel min/max pass over the observations; with compact set,
+    // hours without any observation are dropped through a dense remap table.
+    static TimeAxis from_hours(const std::vector<int32_t>& hours,
+                               bool compact = true)
+    {
+        int32_t lo = std::numeric_limits<int32_t>::max();
+        int32_t hi = std::numeric_limits<int32_t>::min();
+        const int64_t n = static_cast<int64_t>(hours.size());
+
+#pragma omp parallel for reduction(min:lo) reduction(max:hi) schedule(static)
+        for (int64_t i = 0; i < n; ++i) {
+            int32_t h = hours[i];
+            if (h == timeutil::kInvalidHour) continue;
+            lo = std::min(lo, h);
+            hi = std::max(hi, h);
+        }
+
+        if (lo > hi)
+            return TimeAxis();
+
+        size_t span = static_cast<size_t>(hi - lo) + 1;
+
+        if (!compact)
+            return TimeAxis(lo, span);
+
+        std::vector<uint8_t> seen(span, 0);
+        for (int32_t h : hours)
+            if (h != timeutil::kInvalidHour)
+                seen[h - lo] = 1;
+
+        std::vector<int32_t> present;
+        for (size_t off = 0; off < span; ++off)
+            if (seen[off])
+                present.push_back(lo + static_cast<int32_t>(off));
+
+        return from_sorted_hours(std::move(present));
+    }
+
+    size_t size() const { return compact_ ? hours_.size() : span_; }
+    bool compact() const { return compact_; }
+    int32_t min_hour() const { return min_hour_; }
+    int32_t max_hour() const { return min_hour_ + static_cast<int32_t>(span_) - 1; }
+
+    // Time index of an epoch hour, -1 if it is not on the axis
+    int32_t index(int32_t hour) const {
+        if (hour == timeutil::kInvalidHour) return -1;
+        int64_t off = static_cast<int64_t>(hour) - min_hour_;
+        if (off < 0 || off >= static_cast<int64_t>(span_)) return -1;
+        return compact_ ? remap_[off] : static_cast<int32_t>(off);
+    }
+
+    // Epoch hour of time index t
+    int32_t hour(size_t t) const {
+        return compact_ ? hours_[t] : min_hour_ + static_cast<int32_t>(t);
+    }
+
+    // t -> "YYYY-MM-DDTHH"
+    std::string datetime(size_t t) const {
+        return timeutil::format_hour(hour(t));
+    }
+
+    // "YYYY-MM-DDTHH..." -> t, -1 if malformed or not on the axis
+    int32_t index_of(const std::string& datetime) const {
+        return index(timeutil::parse_epoch_hour(datetime));
+    }
+
+    // Half-open index range [t_begin, t_end) of the hours in [hour_begin, hour_end)
+    std::pair<size_t, size_t> range(int32_t hour_begin, int32_t hour_end) const {
+        auto first = [&](int32_t h) -> size_t {
+            if (h <= min_hour_) return 0;
+            if (h > max_hour()) return size();
+            if (!compact_) return static_cast<size_t>(h - min_hour_);
+            return static_cast<size_t>(
+                std::lower_bound(hours_.begin(), hours_.end(), h) - hours_.begin());
+        };
+
+        size_t b = first(hour_begin);
+        size_t e = first(hour_end);
+        return {b, std::max(b, e)};
+    }
+
+    bool operator==(const TimeAxis& other) const {
+        if (size() != other.size()) return false;
+        for (size_t t = 0; t < size(); ++t)
+            if (hour(t) != other.hour(t)) return false;
+        return true;
+    }
+
+    bool operator!=(const TimeAxis& other) const { return !(*this == other); }
+};
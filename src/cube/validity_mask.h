@@ -0,0 +1,149 @@
+#pragma once
+#include "cube_storage.h"
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// C++20 std::popcount / std::countr_zero stand-ins while the tree builds as C++17
+inline int popcount64(uint64_t word) { return __builtin_popcountll(word); }
+inline int ctz64(uint64_t word) { return __builtin_ctzll(word); }
+
+// One bit per (t, lat, lon) cell: set when at least one observation was
+// binned into it, so an empty cell and a 0.0 mm/hr cell stay distinct.
+// Every (t, lat) row is padded to whole 64-bit words, and bit lon of a row
+// is bit lon % 64 of word lon / 64. That lets kernels skip 64 empty cells
+// per zero word and mask a lon range with two word masks.
+//
+// The words are either owned or borrowed (e.g. from a mapped cube file);
+// a borrowed mask is read-only and the memory must outlive it.
+class ValidityMask {
+private:
+    std::size_t T_dim = 0, LAT_dim = 0, LON_dim = 0;
+    std::size_t words = 0;                              // per row
+    std::vector<uint64_t, AlignedAllocator<uint64_t>> owned;
+    const uint64_t* base = nullptr;
+    bool borrowed = false;
+
+public:
+    ValidityMask() = default;
+
+    // All cells empty
+    ValidityMask(std::size_t T, std::size_t LAT, std::size_t LON)
+        : T_dim(T), LAT_dim(LAT), LON_dim(LON), words(words_for(LON)),
+          owned(T * LAT * words_for(LON), 0), base(owned.data()) {}
+
+    // Borrow T × LAT × words_for(LON) packed words
+    static ValidityMask borrow(const uint64_t* bits,
+                               std::size_t T, std::size_t LAT, std::size_t LON)
+    {
+        ValidityMask mask;
+        mask.T_dim = T;
+        mask.LAT_dim = LAT;
+        mask.LON_dim = LON;
+        mask.words = words_for(LON);
+        mask.base = bits;
+        mask.borrowed = true;
+        return mask;
+    }
+
+    // Cells with a positive observation count, one row per task
+    template<typename Cube>
+    static ValidityMask from_counts(const Cube& count)
+    {
+        ValidityMask mask(count.time_dim(), count.lat_dim(), count.lon_dim());
+        const std::size_t rows = mask.T_dim * mask.LAT_dim;
+        const std::size_t LON = mask.LON_dim;
+
+#pragma omp parallel for schedule(static)
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const auto* src = count.row(r / mask.LAT_dim, r % mask.LAT_dim);
+            uint64_t* dst = mask.owned.data() + r * mask.words;
+
+            for (std::size_t lon = 0; lon < LON; ++lon)
+                if (src[lon] > 0)
+                    dst[lon >> 6] |= uint64_t(1) << (lon & 63);
+        }
+
+        return mask;
+    }
+
+    ValidityMask(const ValidityMask& other)
+        : T_dim(other.T_dim), LAT_dim(other.LAT_dim), LON_dim(other.LON_dim),
+          words(other.words), owned(other.owned),
+          base(other.borrowed ? other.base : owned.data()),
+          borrowed(other.borrowed) {}
+
+    ValidityMask(ValidityMask&& other) noexcept
+        : T_dim(other.T_dim), LAT_dim(other.LAT_dim), LON_dim(other.LON_dim),
+          words(other.words), owned(std::move(other.owned)),
+          base(other.borrowed ? other.base : owned.data()),
+          borrowed(other.borrowed) {}
+
+    ValidityMask& operator=(ValidityMask other) noexcept
+    {
+        T_dim = other.T_dim;
+        LAT_dim = other.LAT_dim;
+        LON_dim = other.LON_dim;
+        words = other.words;
+        owned = std::move(other.owned);
+        base = other.borrowed ? other.base : owned.data();
+        borrowed = other.borrowed;
+        return *this;
+    }
+
+    static std::size_t words_for(std::size_t LON) { return (LON + 63) / 64; }
+
+    std::size_t time_dim() const { return T_dim; }
+    std::size_t lat_dim() const { return LAT_dim; }
+    std::size_t lon_dim() const { return LON_dim; }
+    std::size_t words_per_row() const { return words; }
+    std::size_t word_count() const { return T_dim * LAT_dim * words; }
+    std::size_t bytes() const { return word_count() * sizeof(uint64_t); }
+
+    bool is_borrowed() const { return borrowed; }
+
+    template<typename Cube>
+    bool matches(const Cube& cube) const {
+        return cube.time_dim() == T_dim &&
+               cube.lat_dim() == LAT_dim &&
+               cube.lon_dim() == LON_dim;
+    }
+
+    // Packed words of row (t, lat), words_per_row() entries
+    const uint64_t* row(std::size_t t, std::size_t lat) const {
+        if (kCubeBoundsCheck && (t >= T_dim || lat >= LAT_dim))
+            throw std::out_of_range("Row out of bounds");
+        return base + (t * LAT_dim + lat) * words;
+    }
+
+    const uint64_t* data() const { return base; }
+
+    bool test(std::size_t t, std::size_t lat, std::size_t lon) const {
+        if (kCubeBoundsCheck && lon >= LON_dim)
+            throw std::out_of_range("Index out of bounds");
+        return (row(t, lat)[lon >> 6] >> (lon & 63)) & 1;
+    }
+
+    void set(std::size_t t, std::size_t lat, std::size_t lon) {
+        if (borrowed)
+            throw std::logic_error("Cannot modify a borrowed validity mask");
+        if (kCubeBoundsCheck && lon >= LON_dim)
+            throw std::out_of_range("Index out of bounds");
+        owned[(t * LAT_dim + lat) * words + (lon >> 6)] |= uint64_t(1) << (lon & 63);
+    }
+
+    // Observed cells in the whole cube
+    std::size_t count() const {
+        const std::size_t n = word_count();
+        std::size_t total = 0;
+
+#pragma omp parallel for reduction(+:total) schedule(static)
+        for (std::size_t i = 0; i < n; ++i)
+            total += popcount64(base[i]);
+
+        return total;
+    }
+};
@@ -0,0 +1,168 @@
+#include "chunk_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <zlib.h>
+#include <nlohmann/json.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using json = nlohmann::json;
+
+namespace {
+
+// Read-only mapping of one chunk file, unmapped on scope exit
+class MappedChunk {
+public:
+    explicit MappedChunk(const std::string& path)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            size_t len = static_cast<size_t>(st.st_size);
+            void* p = ::mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (p != MAP_FAILED)
+            {
+                ::madvise(p, len, MADV_SEQUENTIAL);
+                addr = static_cast<const uint8_t*>(p);
+                length = len;
+            }
+        }
+
+        ::close(fd);
+    }
+
+    ~MappedChunk()
+    {
+        if (addr)
+            ::munmap(const_cast<uint8_t*>(addr), length);
+    }
+
+    MappedChunk(const MappedChunk&) = delete;
+    MappedChunk& operator=(const MappedChunk&) = delete;
+
+    const uint8_t* data() const { return addr; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* addr = nullptr;
+    size_t length = 0;
+};
+
+} // namespace
+
+ZarrArrayMeta
+ZarrArrayMeta::read(const std::string& folder_path)
+{
+    std::ifstream meta_file(folder_path + "/.zarray");
+    if (!meta_file)
+        throw std::runtime_error("Failed to open .zarray");
+
+    json meta;
+    meta_file >> meta;
+
+    ZarrArrayMeta m;
+    m.path = folder_path;
+    m.dtype = meta["dtype"];
+    m.total_size = meta["shape"][0];
+    m.chunk_size = meta["chunks"][0];
+
+    // "<f4", "|S26", ... : byte width follows the two-char prefix
+    m.element_size = std::stoul(m.dtype.substr(2));
+
+    return m;
+}
+
+size_t
+ZarrArrayMeta::chunk_elements(size_t chunk_index) const
+{
+    size_t offset = chunk_offset(chunk_index);
+
+    if (offset >= total_size)
+        return 0;
+
+    return std::min(chunk_size, total_size - offset);
+}
+
+bool
+ChunkReader::inflate(const ZarrArrayMeta& meta,
+                     size_t chunk_index,
+                     uint8_t* dst,
+                     size_t dst_bytes)
+{
+    MappedChunk chunk(meta.path + "/" + std::to_string(chunk_index));
+
+    if (!chunk.data())
+        return false;
+
+    uLongf dest_len = dst_bytes;
+
+    int res = uncompress(
+        dst,
+        &dest_len,
+        chunk.data(),
+        chunk.size());
+
+    if (res != Z_OK)
+        throw std::runtime_error(
+            "Zlib decompression failed at chunk "
+            + std::to_string(chunk_index));
+
+    return true;
+}
+
+bool
+ChunkReader::read_into(const ZarrArrayMeta& meta,
+                       size_t chunk_index,
+                       void* dst)
+{
+    size_t logical_bytes =
+        meta.chunk_elements(chunk_index) * meta.element_size;
+
+    // Full chunk: inflate directly into the destination slice
+    if (logical_bytes == meta.chunk_bytes())
+    {
+        uint8_t* out = static_cast<uint8_t*>(dst);
+
+        if (!inflate(meta, chunk_index, out, logical_bytes))
+        {
+            std::memset(out, 0, logical_bytes);
+            return false;
+        }
+        return true;
+    }
+
+    // Padded tail chunk: decode into scratch, copy the logical prefix
+    const uint8_t* decoded = read(meta, chunk_index);
+
+    if (!decoded)
+    {
+        std::memset(dst, 0, logical_bytes);
+        return false;
+    }
+
+    std::memcpy(dst, decoded, logical_bytes);
+    return true;
+}
+
+const uint8_t*
+ChunkReader::read(const ZarrArrayMeta& meta, size_t chunk_index)
+{
+    if (scratch.size() < meta.chunk_bytes())
+        scratch.resize(meta.chunk_bytes());
+
+    if (!inflate(meta, chunk_index, scratch.data(), meta.chunk_bytes()))
+        return nullptr;
+
+    return scratch.data();
+}
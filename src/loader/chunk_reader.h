@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Parsed .zarray metadata of a 1-D chunked Zarr array
+struct ZarrArrayMeta {
+    std::string path;
+    std::string dtype;
+    size_t total_size = 0;
+    size_t chunk_size = 0;
+    size_t element_size = 0;
+
+    static ZarrArrayMeta read(const std::string& folder_path);
+
+    size_t num_chunks() const {
+        return (total_size + chunk_size - 1) / chunk_size;
+    }
+
+    size_t chunk_offset(size_t chunk_index) const {
+        return chunk_index * chunk_size;
+    }
+
+    // Elements of this chunk that lie inside the array (tail chunk is short)
+    size_t chunk_elements(size_t chunk_index) const;
+
+    // Decoded size of a chunk on disk; Zarr pads the tail chunk to this
+    size_t chunk_bytes() const {
+        return chunk_size * element_size;
+    }
+};
+
+// Per-thread chunk reader.
+// Each chunk file is mapped read-only and inflated straight into the
+// destination slice; the scratch buffer is kept across calls and only used
+// when a chunk cannot be decoded in place (the padded tail chunk).
+class ChunkReader {
+public:
+    // Decode chunk into dst, which holds chunk_elements(chunk_index) elements.
+    // Missing or empty chunks are zero-filled and return false.
+    bool read_into(const ZarrArrayMeta& meta, size_t chunk_index, void* dst);
+
+    // Decode the full chunk into the reused scratch buffer.
+    // Returns nullptr for missing or empty chunks.
+    const uint8_t* read(const ZarrArrayMeta& meta, size_t chunk_index);
+
+private:
+    std::vector<uint8_t> scratch;
+
+    bool inflate(const ZarrArrayMeta& meta,
+                 size_t chunk_index,
+                 uint8_t* dst,
+                 size_t dst_bytes);
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include "../utils/thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Per-worker load balance of one parallel chunk pass
+struct LoadStats {
+    double wall_seconds = 0.0;
+    std::vector<double> busy_seconds;
+    std::vector<size_t> chunks;
+
+    double idle_seconds(size_t worker) const {
+        return wall_seconds - busy_seconds[worker];
+    }
+
+    void print(std::ostream& os, const std::string& label) const {
+        os << label << ": " << busy_seconds.size() << " workers, "
+           << std::fixed << std::setprecision(3)
+           << wall_seconds << " s wall\n";
+
+        for (size_t w = 0; w < busy_seconds.size(); ++w) {
+            os << "  worker " << w
+               << "  chunks " << chunks[w]
+               << "  busy " << busy_seconds[w] << " s"
+               << "  idle " << idle_seconds(w) << " s\n";
+        }
+    }
+};
+
+// 0 = one worker per ThreadPool thread
+inline unsigned int resolve_loader_threads(unsigned int num_threads) {
+    if (num_threads == 0)
+        num_threads = ThreadPool::instance().size();
+    return num_threads;
+}
+
+// Runs fn(worker, task) for every task in [0, num_tasks).
+// Workers pull the next task from a shared atomic cursor, so a worker that
+// lands on missing or cheap chunks simply takes more of them instead of
+// idling while another straggles through a fixed contiguous block.
+// Workers are ThreadPool tasks, so num_threads above the pool size share
+// pool threads rather than spawning more.
+template<typename Fn>
+void run_chunk_tasks(size_t num_tasks,
+                     unsigned int num_threads,
+                     Fn&& fn,
+                     LoadStats* stats = nullptr)
+{
+    using Clock = std::chrono::steady_clock;
+
+    num_threads = resolve_loader_threads(num_threads);
+    num_threads = static_cast<unsigned int>(
+        std::max<size_t>(1, std::min<size_t>(num_threads, num_tasks)));
+
+    std::atomic<size_t> cursor{0};
+    std::vector<double> busy(num_threads, 0.0);
+    std::vector<size_t> done(num_threads, 0);
+
+    auto worker = [&](unsigned int w) {
+        while (true) {
+            size_t task = cursor.fetch_add(1, std::memory_order_relaxed);
+            if (task >= num_tasks)
+                break;
+
+            auto t0 = Clock::now();
+            fn(w, task);
+            busy[w] += std::chrono::duration<double>(Clock::now() - t0).count();
+            ++done[w];
+        }
+    };
+
+    auto start = Clock::now();
+
+    ThreadPool::instance().parallel_for(num_threads, [&](size_t w) {
+        worker(static_cast<unsigned int>(w));
+    });
+
+    if (stats) {
+        stats->wall_seconds =
+            std::chrono::duration<double>(Clock::now() - start).count();
+        stats->busy_seconds = std::move(busy);
+        stats->chunks = std::move(done);
+    }
+}
@@ -0,0 +1,386 @@
+#include "cube_file.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+uint64_t align_up(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void pad_to(std::ofstream& out, uint64_t offset)
+{
+    static const char zeros[CubeFile::kAlignment] = {};
+
+    uint64_t pos = static_cast<uint64_t>(out.tellp());
+    while (pos < offset)
+    {
+        uint64_t n = std::min<uint64_t>(offset - pos, sizeof(zeros));
+        out.write(zeros, n);
+        pos += n;
+    }
+}
+
+// Float sections of a partial-aggregate file, after the fixed ones
+struct PartialSections {
+    uint32_t flags = 0;
+    const CubeStorage<float>* min = nullptr;
+    const CubeStorage<float>* max = nullptr;
+    const CubeStorage<float>* m2 = nullptr;
+};
+
+void write_file(const std::string& path,
+                CubeView<float> cube,
+                const TimeAxis& axis,
+                const GridSpec& grid,
+                const CubeStorage<int32_t>* count,
+                const ValidityMask* valid,
+                const PartialSections& partial)
+{
+
+    const uint64_t T = cube.time_dim();
+    const uint64_t LAT = cube.lat_dim();
+    const uint64_t LON = cube.lon_dim();
+    const uint64_t cells = T * LAT * LON;
+
+    if (axis.size() != T)
+        throw std::runtime_error("Time axis does not match cube time dimension");
+
+    if (count && (count->time_dim() != T || count->lat_dim() != LAT || count->lon_dim() != LON))
+        throw std::runtime_error("Count cube does not match cube dimensions");
+
+    if (valid && !valid->matches(cube))
+        throw std::runtime_error("Validity mask does not match cube dimensions");
+
+    CubeFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, CubeFile::kMagic, sizeof(h.magic));
+    h.version = CubeFile::kVersion;
+    h.endian = CubeFile::kEndianTag;
+    h.dtype = static_cast<uint32_t>(CubeDtype::Float32);
+    h.layout = static_cast<uint32_t>(CubeLayout::TimeMajor);
+    h.flags = (count ? cube_flags::HAS_COUNT : 0)
+            | (axis.compact() ? cube_flags::COMPACT_AXIS : 0)
+            | (valid ? cube_flags::HAS_VALIDITY : 0)
+            | partial.flags
+            | (partial.min ? cube_flags::HAS_MIN : 0)
+            | (partial.max ? cube_flags::HAS_MAX : 0)
+            | (partial.m2 ? cube_flags::HAS_M2 : 0);
+
+    h.time_dim = T;
+    h.lat_dim = LAT;
+    h.lon_dim = LON;
+
+    h.lat_min = grid.lat_min;
+    h.lat_max = grid.lat_max;
+    h.lon_min = grid.lon_min;
+    h.lon_max = grid.lon_max;
+    h.resolution = grid.resolution;
+
+    h.data_offset = CubeFile::kAlignment;
+    h.data_bytes = cells * sizeof(float);
+
+    uint64_t next = align_up(h.data_offset + h.data_bytes, CubeFile::kAlignment);
+    if (count)
+    {
+        h.count_offset = next;
+        h.count_bytes = cells * sizeof(int32_t);
+        next = align_up(h.count_offset + h.count_bytes, CubeFile::kAlignment);
+    }
+
+    h.hours_offset = next;
+    h.hours_bytes = T * sizeof(int32_t);
+    next = align_up(h.hours_offset + h.hours_bytes, CubeFile::kAlignment);
+
+    if (valid)
+    {
+        h.valid_offset = next;
+        h.valid_bytes = valid->bytes();
+        next = align_up(h.valid_offset + h.valid_bytes, CubeFile::kAlignment);
+    }
+
+    auto place = [&](const CubeStorage<float>* section, uint64_t& offset, uint64_t& bytes) {
+        if (!section)
+            return;
+        if (section->time_dim() != T || section->lat_dim() != LAT || section->lon_dim() != LON)
+            throw std::runtime_error("Measure cube does not match cube dimensions");
+        offset = next;
+        bytes = cells * sizeof(float);
+        next = align_up(offset + bytes, CubeFile::kAlignment);
+    };
+
+    place(partial.min, h.min_offset, h.min_bytes);
+    place(partial.max, h.max_offset, h.max_bytes);
+    place(partial.m2, h.m2_offset, h.m2_bytes);
+
+    const std::string tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out)
+        throw std::runtime_error("Failed to open " + tmp_path);
+
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+
+    pad_to(out, h.data_offset);
+    for (uint64_t t = 0; t < T; ++t)
+        for (uint64_t lat = 0; lat < LAT; ++lat)
+            out.write(reinterpret_cast<const char*>(cube.row(t, lat)), LON * sizeof(float));
+
+    if (count)
+    {
+        pad_to(out, h.count_offset);
+        for (uint64_t t = 0; t < T; ++t)
+            for (uint64_t lat = 0; lat < LAT; ++lat)
+                out.write(reinterpret_cast<const char*>(count->row(t, lat)), LON * sizeof(int32_t));
+    }
+
+    std::vector<int32_t> hours(T);
+    for (uint64_t t = 0; t < T; ++t)
+        hours[t] = axis.hour(t);
+
+    pad_to(out, h.hours_offset);
+    out.write(reinterpret_cast<const char*>(hours.data()), h.hours_bytes);
+
+    if (valid)
+    {
+        pad_to(out, h.valid_offset);
+        out.write(reinterpret_cast<const char*>(valid->data()), h.valid_bytes);
+    }
+
+    for (auto section : {std::make_pair(partial.min, h.min_offset),
+                         std::make_pair(partial.max, h.max_offset),
+                         std::make_pair(partial.m2, h.m2_offset)})
+    {
+        if (!section.first)
+            continue;
+        pad_to(out, section.second);
+        out.write(reinterpret_cast<const char*>(section.first->data()), cells * sizeof(float));
+    }
+
+    out.close();
+    if (!out)
+        throw std::runtime_error("Failed to write " + tmp_path);
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Failed to move cube file into place: " + path);
+}
+
+} // namespace
+
+void
+CubeFile::write(const std::string& path,
+                CubeView<float> cube,
+                const TimeAxis& axis,
+                const GridSpec& grid,
+                const CubeStorage<int32_t>* count,
+                const ValidityMask* valid)
+{
+    write_file(path, cube, axis, grid, count, valid, PartialSections());
+}
+
+void
+CubeFile::write(const std::string& path,
+                const PartialCube& partial,
+                const GridSpec& grid)
+{
+    const MeasureCube& m = partial.measures();
+
+    PartialSections sections;
+    sections.flags = cube_flags::SUM_VALUES;
+    sections.min = m.has(measure::min) ? &m.min : nullptr;
+    sections.max = m.has(measure::max) ? &m.max : nullptr;
+    sections.m2 = m.has(measure::m2) ? &m.m2 : nullptr;
+
+    write_file(path, m.sum, partial.axis(), grid, &m.count, nullptr, sections);
+}
+
+MappedCube::MappedCube(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open cube file " + path);
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CubeFileHeader)))
+    {
+        ::close(fd);
+        throw std::runtime_error("Cube file too small: " + path);
+    }
+
+    length = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (p == MAP_FAILED)
+        throw std::runtime_error("Failed to mmap cube file " + path);
+
+    addr = static_cast<const uint8_t*>(p);
+    hdr = section<CubeFileHeader>(0);
+
+    auto fail = [&](const std::string& why) {
+        ::munmap(const_cast<uint8_t*>(addr), length);
+        throw std::runtime_error("Invalid cube file " + path + ": " + why);
+    };
+
+    if (std::memcmp(hdr->magic, CubeFile::kMagic, sizeof(hdr->magic)) != 0)
+        fail("bad magic");
+    if (hdr->version < 1 || hdr->version > CubeFile::kVersion)
+        fail("unsupported version " + std::to_string(hdr->version));
+    if (hdr->endian != CubeFile::kEndianTag)
+        fail("written with a different byte order");
+    if (hdr->dtype != static_cast<uint32_t>(CubeDtype::Float32))
+        fail("unsupported dtype");
+    if (hdr->layout != static_cast<uint32_t>(CubeLayout::TimeMajor))
+        fail("unsupported layout");
+
+    // Every section size below is at most 8 bytes per cell (validity
+    // words pad each row by < 64 cells), so bounding that keeps the size
+    // arithmetic from wrapping on a crafted header
+    uint64_t cells, bound;
+    if (hdr->lon_dim > std::numeric_limits<uint32_t>::max() ||
+        __builtin_mul_overflow(hdr->time_dim, hdr->lat_dim, &cells) ||
+        __builtin_mul_overflow(cells, hdr->lon_dim + 64, &bound) ||
+        __builtin_mul_overflow(bound, sizeof(uint64_t), &bound) ||
+        __builtin_mul_overflow(hdr->time_dim, sizeof(uint64_t), &bound))
+        fail("dimensions overflow");
+    cells *= hdr->lon_dim;
+
+    auto in_file = [&](uint64_t offset, uint64_t bytes) {
+        return offset % alignof(float) == 0 && offset <= length && bytes <= length - offset;
+    };
+
+    if (hdr->data_bytes != cells * sizeof(float) || !in_file(hdr->data_offset, hdr->data_bytes))
+        fail("data section out of range");
+    if (has_count() &&
+        (hdr->count_bytes != cells * sizeof(int32_t) || !in_file(hdr->count_offset, hdr->count_bytes)))
+        fail("count section out of range");
+    if (hdr->hours_bytes != hdr->time_dim * sizeof(int32_t) || !in_file(hdr->hours_offset, hdr->hours_bytes))
+        fail("time axis section out of range");
+    if (has_validity() &&
+        (hdr->version < 2 ||
+         hdr->valid_offset % alignof(uint64_t) != 0 ||
+         hdr->valid_bytes != hdr->time_dim * hdr->lat_dim *
+                             ValidityMask::words_for(hdr->lon_dim) * sizeof(uint64_t) ||
+         !in_file(hdr->valid_offset, hdr->valid_bytes)))
+        fail("validity section out of range");
+
+    auto measure_ok = [&](uint32_t flag, uint64_t offset, uint64_t bytes) {
+        return !(hdr->flags & flag) ||
+               (hdr->version >= 3 && bytes == cells * sizeof(float) && in_file(offset, bytes));
+    };
+
+    if (holds_sums() && (hdr->version < 3 || !has_count()))
+        fail("partial aggregates without counts");
+    if (!measure_ok(cube_flags::HAS_MIN, hdr->min_offset, hdr->min_bytes) ||
+        !measure_ok(cube_flags::HAS_MAX, hdr->max_offset, hdr->max_bytes) ||
+        !measure_ok(cube_flags::HAS_M2, hdr->m2_offset, hdr->m2_bytes))
+        fail("measure section out of range");
+
+    const int32_t* hours = section<int32_t>(hdr->hours_offset);
+
+    const bool compact = hdr->flags & cube_flags::COMPACT_AXIS;
+
+    // Compact hours must be strictly ascending, contiguous ones consecutive
+    for (uint64_t t = 0; t < hdr->time_dim; ++t)
+    {
+        if (hours[t] == timeutil::kInvalidHour)
+            fail("invalid hour on the time axis");
+        if (t == 0)
+            continue;
+
+        const int64_t step = static_cast<int64_t>(hours[t]) - hours[t - 1];
+        if (compact ? step <= 0 : step != 1)
+            fail(compact ? "time axis hours not ascending" : "time axis hours not contiguous");
+    }
+
+    if (compact)
+        time_axis = TimeAxis::from_sorted_hours(
+            std::vector<int32_t>(hours, hours + hdr->time_dim));
+    else if (hdr->time_dim > 0)
+        time_axis = TimeAxis(hours[0], hdr->time_dim);
+}
+
+MappedCube::~MappedCube()
+{
+    if (addr)
+        ::munmap(const_cast<uint8_t*>(addr), length);
+}
+
+CubeView<float>
+MappedCube::cube() const
+{
+    return CubeView<float>(section<float>(hdr->data_offset),
+                           hdr->time_dim, hdr->lat_dim, hdr->lon_dim,
+                           hdr->lat_dim * hdr->lon_dim, hdr->lon_dim);
+}
+
+CubeView<int32_t>
+MappedCube::count() const
+{
+    if (!has_count())
+        throw std::runtime_error("Cube file has no count section");
+
+    return CubeView<int32_t>(section<int32_t>(hdr->count_offset),
+                             hdr->time_dim, hdr->lat_dim, hdr->lon_dim,
+                             hdr->lat_dim * hdr->lon_dim, hdr->lon_dim);
+}
+
+ValidityMask
+MappedCube::validity() const
+{
+    if (!has_validity())
+        throw std::runtime_error("Cube file has no validity section");
+
+    return ValidityMask::borrow(section<uint64_t>(hdr->valid_offset),
+                                hdr->time_dim, hdr->lat_dim, hdr->lon_dim);
+}
+
+PartialCube
+MappedCube::partial() const
+{
+    if (!holds_sums())
+        throw std::runtime_error("Cube file does not hold partial aggregates");
+
+    const size_t T = hdr->time_dim, LAT = hdr->lat_dim, LON = hdr->lon_dim;
+    const size_t cells = T * LAT * LON;
+
+    unsigned measures = PartialCube::kRequired;
+    if (hdr->flags & cube_flags::HAS_MIN) measures |= measure::min;
+    if (hdr->flags & cube_flags::HAS_MAX) measures |= measure::max;
+    if (hdr->flags & cube_flags::HAS_M2)  measures |= measure::m2;
+
+    MeasureCube m(measures);
+    m.reset(T, LAT, LON);
+
+    std::copy_n(section<float>(hdr->data_offset), cells, m.sum.data());
+    std::copy_n(section<int32_t>(hdr->count_offset), cells, m.count.data());
+    if (m.has(measure::min)) std::copy_n(section<float>(hdr->min_offset), cells, m.min.data());
+    if (m.has(measure::max)) std::copy_n(section<float>(hdr->max_offset), cells, m.max.data());
+    if (m.has(measure::m2))  std::copy_n(section<float>(hdr->m2_offset), cells, m.m2.data());
+
+    return PartialCube(time_axis, std::move(m));
+}
+
+GridSpec
+MappedCube::grid() const
+{
+    GridSpec g;
+    g.lat_min = hdr->lat_min;
+    g.lat_max = hdr->lat_max;
+    g.lon_min = hdr->lon_min;
+    g.lon_max = hdr->lon_max;
+    g.resolution = hdr->resolution;
+    return g;
+}
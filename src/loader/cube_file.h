@@ -0,0 +1,148 @@
+#pragma once
+#include "../cube/cube_storage.h"
+#include "../cube/cube_view.h"
+#include "../cube/grid_spec.h"
+#include "../cube/partial_cube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Native on-disk cube: one page-sized header followed by page-aligned raw
+// sections, so a reader can mmap the file and query it in place.
+//
+//   [0, 4096)          CubeFileHeader
+//   data_offset        T × LAT × LON values, t-major rows
+//   count_offset       T × LAT × LON int32 observation counts (HAS_COUNT)
+//   hours_offset       T int32 epoch hours of the time axis
+//   valid_offset       T × LAT × ceil(LON / 64) uint64 validity words (HAS_VALIDITY)
+//   min/max/m2_offset  T × LAT × LON float partial measures (HAS_MIN/MAX/M2)
+//
+// A partial-aggregate file (SUM_VALUES) stores per-cell sums in the data
+// section and always has counts, so shards written by separate processes
+// can be merged exactly.
+//
+// Values are stored in native (little-endian) byte order; the endian tag
+// rejects files written on a machine with the other order.
+
+enum class CubeDtype : uint32_t { Float32 = 1 };
+enum class CubeLayout : uint32_t { TimeMajor = 0 };
+
+namespace cube_flags {
+    constexpr uint32_t HAS_COUNT = 1u << 0;    // count section present
+    constexpr uint32_t COMPACT_AXIS = 1u << 1; // hours are a compact axis
+    constexpr uint32_t HAS_VALIDITY = 1u << 2; // validity section present (v2)
+    constexpr uint32_t SUM_VALUES = 1u << 3;   // data holds sums, not means (v3)
+    constexpr uint32_t HAS_MIN = 1u << 4;      // min section present (v3)
+    constexpr uint32_t HAS_MAX = 1u << 5;      // max section present (v3)
+    constexpr uint32_t HAS_M2 = 1u << 6;       // M2 section present (v3)
+}
+
+struct CubeFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t flags;
+    uint32_t reserved;
+
+    uint64_t time_dim;
+    uint64_t lat_dim;
+    uint64_t lon_dim;
+
+    double lat_min;
+    double lat_max;
+    double lon_min;
+    double lon_max;
+    double resolution;
+
+    uint64_t data_offset;
+    uint64_t data_bytes;
+    uint64_t count_offset;
+    uint64_t count_bytes;
+    uint64_t hours_offset;
+    uint64_t hours_bytes;
+
+    // Version 2; zero in version 1 files (the header page is zero-padded)
+    uint64_t valid_offset;
+    uint64_t valid_bytes;
+
+    // Version 3; zero in older files
+    uint64_t min_offset;
+    uint64_t min_bytes;
+    uint64_t max_offset;
+    uint64_t max_bytes;
+    uint64_t m2_offset;
+    uint64_t m2_bytes;
+};
+
+class CubeFile {
+public:
+    static constexpr char kMagic[8] = {'G', 'P', 'M', 'C', 'U', 'B', 'E', '\0'};
+    static constexpr uint32_t kVersion = 3;      // readers accept 1 to 3
+    static constexpr uint32_t kEndianTag = 0x01020304;
+    static constexpr size_t kAlignment = 4096;
+
+    // Write cube (plus optional per-cell counts and validity mask) with its
+    // axis and grid.
+    // The file is written next to path and renamed into place, so readers
+    // never map a half-written cube.
+    static void write(const std::string& path,
+                      CubeView<float> cube,
+                      const TimeAxis& axis,
+                      const GridSpec& grid = GridSpec(),
+                      const CubeStorage<int32_t>* count = nullptr,
+                      const ValidityMask* valid = nullptr);
+
+    // Write a partial-aggregate cube: sums, counts and whichever of
+    // min, max and M2 it holds
+    static void write(const std::string& path,
+                      const PartialCube& partial,
+                      const GridSpec& grid = GridSpec());
+};
+
+// Read-only mapping of a cube file.
+// The data sections are used in place: pages come from the page cache and
+// are shared by every process mapping the same file.
+class MappedCube {
+public:
+    explicit MappedCube(const std::string& path);
+    ~MappedCube();
+
+    MappedCube(const MappedCube&) = delete;
+    MappedCube& operator=(const MappedCube&) = delete;
+
+    const CubeFileHeader& header() const { return *hdr; }
+
+    // Means, or per-cell sums in a partial-aggregate file (holds_sums())
+    CubeView<float> cube() const;
+    bool has_count() const { return hdr->flags & cube_flags::HAS_COUNT; }
+    bool holds_sums() const { return hdr->flags & cube_flags::SUM_VALUES; }
+    CubeView<int32_t> count() const;
+
+    // Borrowed view of the mapped validity words
+    bool has_validity() const { return hdr->flags & cube_flags::HAS_VALIDITY; }
+    ValidityMask validity() const;
+
+    // Owned copy of a partial-aggregate file, ready to merge
+    PartialCube partial() const;
+
+    const TimeAxis& axis() const { return time_axis; }
+    GridSpec grid() const;
+
+    size_t file_size() const { return length; }
+
+private:
+    const uint8_t* addr = nullptr;
+    size_t length = 0;
+    const CubeFileHeader* hdr = nullptr;
+    TimeAxis time_axis;
+
+    template<typename T>
+    const T* section(uint64_t offset) const {
+        return reinterpret_cast<const T*>(addr + offset);
+    }
+};
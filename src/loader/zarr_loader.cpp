@@ -1,248 +1,331 @@
 #include "zarr_loader.h"
+#include "chunk_reader.h"
+#include "../utils/time_utils.h"
 
-#include <atomic>
+#include <algorithm>
 #include <cstddef>
-#include <fstream>
 #include <vector>
 #include <cstring>
-#include <zlib.h>
 #include <stdexcept>
-#include <nlohmann/json.hpp>
 
-using json = nlohmann::json;
+namespace {
 
-#include <thread>
-
-std::vector<float>
-ZarrLoader::load_float_array(const std::string& folder_path)
+ZarrArrayMeta read_float_meta(const std::string& folder_path)
 {
-    std::ifstream meta_file(folder_path + "/.zarray");
-    if (!meta_file)
-        throw std::runtime_error("Failed to open .zarray");
-
-    json meta;
-    meta_file >> meta;
+    ZarrArrayMeta meta = ZarrArrayMeta::read(folder_path);
 
-    size_t total_size = meta["shape"][0];
-    size_t chunk_size = meta["chunks"][0];
+    if (meta.element_size != sizeof(float))
+        throw std::runtime_error("Expected <f4 array at " + folder_path);
 
-    size_t num_chunks =
-        (total_size + chunk_size - 1) / chunk_size;
-
-    std::vector<float> result(total_size);
+    return meta;
+}
 
-    unsigned int num_threads =
-        std::thread::hardware_concurrency();
-    if (num_threads == 0) num_threads = 4;
+// out points at the chunk's first element
+void decode_float_chunk(ChunkReader& reader,
+                        const ZarrArrayMeta& meta,
+                        size_t chunk_index,
+                        float* out)
+{
+    reader.read_into(meta, chunk_index, out);
+}
 
-    size_t chunks_per_thread =
-        (num_chunks + num_threads - 1) / num_threads;
+void decode_string_chunk(ChunkReader& reader,
+                         const ZarrArrayMeta& meta,
+                         size_t chunk_index,
+                         std::vector<std::string>& result)
+{
+    size_t offset = meta.chunk_offset(chunk_index);
+    size_t logical_elements = meta.chunk_elements(chunk_index);
+    size_t element_size = meta.element_size;
 
-    std::vector<std::thread> threads;
+    // Missing chunks keep their default-constructed ""
+    const uint8_t* decoded = reader.read(meta, chunk_index);
+    if (!decoded)
+        return;
 
-    auto worker = [&](size_t start_chunk, size_t end_chunk)
+    for (size_t i = 0; i < logical_elements; ++i)
     {
-        for (size_t chunk_index = start_chunk;
-             chunk_index < end_chunk;
-             ++chunk_index)
-        {
-            size_t offset = chunk_index * chunk_size;
+        const char* ptr =
+            reinterpret_cast<const char*>(
+                decoded + i * element_size);
 
-            if (offset >= total_size)
-                break;
+        const void* nul = std::memchr(ptr, '\0', element_size);
+        size_t len = nul
+            ? static_cast<const char*>(nul) - ptr
+            : element_size;
 
-            size_t remaining = total_size - offset;
-            size_t logical_elements =
-                std::min(chunk_size, remaining);
+        result[offset + i].assign(ptr, len);
+    }
+}
 
-            size_t full_chunk_bytes =
-                chunk_size * sizeof(float);
+void decode_hour_chunk(ChunkReader& reader,
+                       const ZarrArrayMeta& meta,
+                       size_t chunk_index,
+                       int32_t* out)
+{
+    size_t logical_elements = meta.chunk_elements(chunk_index);
+    size_t element_size = meta.element_size;
 
-            std::string chunk_path =
-                folder_path + "/" +
-                std::to_string(chunk_index);
+    const uint8_t* decoded = reader.read(meta, chunk_index);
+    if (!decoded)
+    {
+        std::fill(out, out + logical_elements, timeutil::kInvalidHour);
+        return;
+    }
 
-            std::ifstream chunk_file(chunk_path,
-                                     std::ios::binary);
+    for (size_t i = 0; i < logical_elements; ++i)
+    {
+        out[i] = timeutil::parse_epoch_hour(
+            reinterpret_cast<const char*>(decoded + i * element_size),
+            element_size);
+    }
+}
 
-            if (!chunk_file)
-            {
-                std::memset(result.data() + offset,
-                            0,
-                            logical_elements * sizeof(float));
-                continue;
-            }
+std::string join_path(const std::string& store_path,
+                      const std::string& name)
+{
+    if (!store_path.empty() && store_path.back() == '/')
+        return store_path + name;
+    return store_path + "/" + name;
+}
 
-            std::vector<unsigned char> compressed(
-                (std::istreambuf_iterator<char>(chunk_file)),
-                std::istreambuf_iterator<char>());
+} // namespace
 
-            if (compressed.empty())
-            {
-                std::memset(result.data() + offset,
-                            0,
-                            logical_elements * sizeof(float));
-                continue;
-            }
+std::vector<float>
+ZarrLoader::load_float_array(const std::string& folder_path,
+                             unsigned int num_threads,
+                             LoadStats* stats)
+{
+    ZarrArrayMeta meta = read_float_meta(folder_path);
 
-            std::vector<unsigned char> decompressed(full_chunk_bytes);
-            uLongf dest_len = full_chunk_bytes;
+    std::vector<float> result(meta.total_size);
 
-            int res = uncompress(
-                decompressed.data(),
-                &dest_len,
-                compressed.data(),
-                compressed.size());
+    num_threads = resolve_loader_threads(num_threads);
+    std::vector<ChunkReader> readers(num_threads);
 
-            if (res != Z_OK)
-                throw std::runtime_error(
-                    "Zlib decompression failed at chunk "
-                    + std::to_string(chunk_index));
+    run_chunk_tasks(meta.num_chunks(), num_threads,
+        [&](unsigned int worker, size_t chunk_index)
+        {
+            decode_float_chunk(readers[worker], meta, chunk_index,
+                               result.data() + meta.chunk_offset(chunk_index));
+        },
+        stats);
 
-            std::memcpy(result.data() + offset,
-                        decompressed.data(),
-                        logical_elements * sizeof(float));
-        }
-    };
+    return result;
+}
 
-    for (size_t t = 0; t < num_threads; ++t)
-    {
-        size_t start = t * chunks_per_thread;
-        size_t end =
-            std::min(start + chunks_per_thread,
-                     num_chunks);
+std::vector<std::string>
+ZarrLoader::load_string_array(
+    const std::string& folder_path,
+    unsigned int num_threads,
+    LoadStats* stats)
+{
+    ZarrArrayMeta meta = ZarrArrayMeta::read(folder_path);
 
-        if (start >= num_chunks) break;
+    std::vector<std::string> result(meta.total_size);
 
-        threads.emplace_back(worker, start, end);
-    }
+    num_threads = resolve_loader_threads(num_threads);
+    std::vector<ChunkReader> readers(num_threads);
 
-    for (auto& th : threads)
-        th.join();
+    run_chunk_tasks(meta.num_chunks(), num_threads,
+        [&](unsigned int worker, size_t chunk_index)
+        {
+            decode_string_chunk(readers[worker], meta, chunk_index, result);
+        },
+        stats);
 
     return result;
 }
 
-std::vector<std::string>
-ZarrLoader::load_string_array(
-    const std::string& folder_path)
+std::vector<int32_t>
+ZarrLoader::load_timestamp_hours(
+    const std::string& folder_path,
+    unsigned int num_threads,
+    LoadStats* stats)
 {
-    std::ifstream meta_file(folder_path + "/.zarray");
-    if (!meta_file)
-        throw std::runtime_error("Failed to open .zarray");
+    ZarrArrayMeta meta = ZarrArrayMeta::read(folder_path);
 
-    json meta;
-    meta_file >> meta;
+    std::vector<int32_t> result(meta.total_size);
 
-    size_t total_size = meta["shape"][0];
-    size_t chunk_size = meta["chunks"][0];
+    num_threads = resolve_loader_threads(num_threads);
+    std::vector<ChunkReader> readers(num_threads);
 
-    std::string dtype = meta["dtype"];
-    size_t element_size = std::stoul(dtype.substr(2));
+    run_chunk_tasks(meta.num_chunks(), num_threads,
+        [&](unsigned int worker, size_t chunk_index)
+        {
+            decode_hour_chunk(readers[worker], meta, chunk_index,
+                              result.data() + meta.chunk_offset(chunk_index));
+        },
+        stats);
 
-    size_t num_chunks =
-        (total_size + chunk_size - 1) / chunk_size;
+    return result;
+}
 
-    std::vector<std::string> result(total_size);
+ZarrGroup
+ZarrLoader::load_group(const std::string& store_path,
+                       const std::vector<std::string>& float_arrays,
+                       const std::vector<std::string>& string_arrays,
+                       const std::vector<std::string>& hour_arrays,
+                       unsigned int num_threads,
+                       LoadStats* stats)
+{
+    ZarrGroup group;
 
-    unsigned int num_threads =
-        std::thread::hardware_concurrency();
-    if (num_threads == 0) num_threads = 4;
+    // Arrays are laid out floats, then strings, then hours
+    enum class Kind { Float, String, Hour };
 
-    size_t chunks_per_thread =
-        (num_chunks + num_threads - 1) / num_threads;
+    std::vector<ZarrArrayMeta> metas;
+    std::vector<Kind> kinds;
+    std::vector<void*> outputs;
 
-    std::vector<std::thread> threads;
+    for (const auto& name : float_arrays)
+    {
+        metas.push_back(read_float_meta(join_path(store_path, name)));
+        auto& out = group.floats[name];
+        out.resize(metas.back().total_size);
+        kinds.push_back(Kind::Float);
+        outputs.push_back(&out);
+    }
 
-    auto worker = [&](size_t start_chunk, size_t end_chunk)
+    for (const auto& name : string_arrays)
     {
-        for (size_t chunk_index = start_chunk;
-             chunk_index < end_chunk;
-             ++chunk_index)
-        {
-            size_t offset = chunk_index * chunk_size;
+        metas.push_back(ZarrArrayMeta::read(join_path(store_path, name)));
+        auto& out = group.strings[name];
+        out.resize(metas.back().total_size);
+        kinds.push_back(Kind::String);
+        outputs.push_back(&out);
+    }
 
-            if (offset >= total_size)
-                break;
+    for (const auto& name : hour_arrays)
+    {
+        metas.push_back(ZarrArrayMeta::read(join_path(store_path, name)));
+        auto& out = group.hours[name];
+        out.resize(metas.back().total_size);
+        kinds.push_back(Kind::Hour);
+        outputs.push_back(&out);
+    }
 
-            size_t remaining = total_size - offset;
-            size_t logical_elements =
-                std::min(chunk_size, remaining);
+    // Round-robin over arrays so consecutive tasks hit different files
+    struct ChunkTask {
+        size_t array;
+        size_t chunk;
+    };
 
-            size_t full_chunk_bytes =
-                chunk_size * element_size;
+    std::vector<ChunkTask> tasks;
+    size_t max_chunks = 0;
 
-            std::string chunk_path =
-                folder_path + "/" +
-                std::to_string(chunk_index);
+    for (const auto& meta : metas)
+        max_chunks = std::max(max_chunks, meta.num_chunks());
 
-            std::ifstream chunk_file(chunk_path,
-                                     std::ios::binary);
+    for (size_t c = 0; c < max_chunks; ++c)
+        for (size_t a = 0; a < metas.size(); ++a)
+            if (c < metas[a].num_chunks())
+                tasks.push_back({a, c});
 
-            if (!chunk_file)
-            {
-                for (size_t i = 0; i < logical_elements; ++i)
-                    result[offset + i] = "";
-                continue;
-            }
+    num_threads = resolve_loader_threads(num_threads);
+    std::vector<ChunkReader> readers(num_threads);
 
-            std::vector<uint8_t> compressed(
-                (std::istreambuf_iterator<char>(chunk_file)),
-                std::istreambuf_iterator<char>());
+    run_chunk_tasks(tasks.size(), num_threads,
+        [&](unsigned int worker, size_t task_index)
+        {
+            const ChunkTask& task = tasks[task_index];
+            const ZarrArrayMeta& meta = metas[task.array];
 
-            if (compressed.empty())
+            void* out = outputs[task.array];
+            size_t offset = meta.chunk_offset(task.chunk);
+
+            switch (kinds[task.array])
             {
-                for (size_t i = 0; i < logical_elements; ++i)
-                    result[offset + i] = "";
-                continue;
+            case Kind::Float:
+                decode_float_chunk(readers[worker], meta, task.chunk,
+                    static_cast<std::vector<float>*>(out)->data() + offset);
+                break;
+            case Kind::String:
+                decode_string_chunk(readers[worker], meta, task.chunk,
+                    *static_cast<std::vector<std::string>*>(out));
+                break;
+            case Kind::Hour:
+                decode_hour_chunk(readers[worker], meta, task.chunk,
+                    static_cast<std::vector<int32_t>*>(out)->data() + offset);
+                break;
             }
+        },
+        stats);
 
-            std::vector<uint8_t> decompressed(full_chunk_bytes);
-            uLongf dest_len = full_chunk_bytes;
+    return group;
+}
 
-            int res = uncompress(
-                decompressed.data(),
-                &dest_len,
-                compressed.data(),
-                compressed.size());
+void
+ZarrLoader::stream_chunks(const std::string& store_path,
+                          const std::vector<std::string>& float_arrays,
+                          const std::vector<std::string>& hour_arrays,
+                          const ChunkCallback& fn,
+                          unsigned int num_threads,
+                          LoadStats* stats)
+{
+    std::vector<ZarrArrayMeta> float_metas;
+    std::vector<ZarrArrayMeta> hour_metas;
 
-            if (res != Z_OK)
-                throw std::runtime_error(
-                    "Zlib decompression failed at chunk "
-                    + std::to_string(chunk_index));
+    for (const auto& name : float_arrays)
+        float_metas.push_back(read_float_meta(join_path(store_path, name)));
 
-            for (size_t i = 0; i < logical_elements; ++i)
-            {
-                const char* ptr =
-                    reinterpret_cast<const char*>(
-                        decompressed.data() +
-                        i * element_size);
+    for (const auto& name : hour_arrays)
+        hour_metas.push_back(ZarrArrayMeta::read(join_path(store_path, name)));
 
-                std::string s(ptr, element_size);
+    if (float_metas.empty() && hour_metas.empty())
+        return;
 
-                size_t null_pos = s.find('\0');
-                if (null_pos != std::string::npos)
-                    s.resize(null_pos);
+    // Chunk i of every array must cover the same observations
+    const ZarrArrayMeta& first =
+        float_metas.empty() ? hour_metas.front() : float_metas.front();
 
-                result[offset + i] = s;
-            }
-        }
+    for (const auto* metas : {&float_metas, &hour_metas})
+        for (const auto& meta : *metas)
+            if (meta.total_size != first.total_size ||
+                meta.chunk_size != first.chunk_size)
+                throw std::runtime_error(
+                    "Arrays are not chunked alike: " + meta.path);
+
+    // Per-worker chunk buffers, reused for every chunk the worker takes
+    struct WorkerBuffers {
+        ChunkReader reader;
+        std::vector<std::vector<float>> floats;
+        std::vector<std::vector<int32_t>> hours;
+        ChunkBatch batch;
     };
 
-    for (size_t t = 0; t < num_threads; ++t)
-    {
-        size_t start = t * chunks_per_thread;
-        size_t end =
-            std::min(start + chunks_per_thread,
-                     num_chunks);
+    num_threads = resolve_loader_threads(num_threads);
+    std::vector<WorkerBuffers> workers(num_threads);
 
-        if (start >= num_chunks) break;
+    for (auto& w : workers)
+    {
+        w.floats.assign(float_metas.size(), std::vector<float>(first.chunk_size));
+        w.hours.assign(hour_metas.size(), std::vector<int32_t>(first.chunk_size));
 
-        threads.emplace_back(worker, start, end);
+        for (auto& buf : w.floats)
+            w.batch.floats.push_back(buf.data());
+        for (auto& buf : w.hours)
+            w.batch.hours.push_back(buf.data());
     }
 
-    for (auto& th : threads)
-        th.join();
+    run_chunk_tasks(first.num_chunks(), num_threads,
+        [&](unsigned int worker, size_t chunk_index)
+        {
+            WorkerBuffers& w = workers[worker];
+
+            for (size_t a = 0; a < float_metas.size(); ++a)
+                decode_float_chunk(w.reader, float_metas[a], chunk_index,
+                                   w.floats[a].data());
 
-    return result;
+            for (size_t a = 0; a < hour_metas.size(); ++a)
+                decode_hour_chunk(w.reader, hour_metas[a], chunk_index,
+                                  w.hours[a].data());
+
+            w.batch.chunk_index = chunk_index;
+            w.batch.offset = first.chunk_offset(chunk_index);
+            w.batch.count = first.chunk_elements(chunk_index);
+
+            fn(worker, w.batch);
+        },
+        stats);
 }
@@ -1,15 +1,72 @@
 #pragma once
+#include "chunk_scheduler.h"
+
 #include <cstdint>
+#include <functional>
+#include <map>
 #include <string>
 #include <vector>
 
+// Arrays of one Zarr store, keyed by array name
+struct ZarrGroup {
+    std::map<std::string, std::vector<float>> floats;
+    std::map<std::string, std::vector<std::string>> strings;
+    std::map<std::string, std::vector<int32_t>> hours;
+};
+
+// Chunk i of several arrays, decoded into a worker's reusable buffers.
+// Pointers stay valid only for the duration of the callback.
+struct ChunkBatch {
+    size_t chunk_index = 0;
+    size_t offset = 0;                    // first observation in the chunk
+    size_t count = 0;                     // observations in the chunk
+    std::vector<const float*> floats;     // in float_arrays order
+    std::vector<const int32_t*> hours;    // in hour_arrays order
+};
+
 class ZarrLoader {
 public:
+    using ChunkCallback =
+        std::function<void(unsigned int worker, const ChunkBatch& batch)>;
+
     // Load float32 array (<f4)
     static std::vector<float>
-    load_float_array(const std::string& folder_path);
+    load_float_array(const std::string& folder_path,
+                     unsigned int num_threads = 0,  // 0 = auto-detect
+                     LoadStats* stats = nullptr);
 
     // Load fixed-width string array (|SXX)
     static std::vector<std::string>
-    load_string_array(const std::string& folder_path);
+    load_string_array(const std::string& folder_path,
+                      unsigned int num_threads = 0,  // 0 = auto-detect
+                      LoadStats* stats = nullptr);
+
+    // Decode fixed-width timestamps (|SXX) straight to hours since epoch.
+    // Missing chunks and malformed entries become timeutil::kInvalidHour.
+    static std::vector<int32_t>
+    load_timestamp_hours(const std::string& folder_path,
+                         unsigned int num_threads = 0,  // 0 = auto-detect
+                         LoadStats* stats = nullptr);
+
+    // Load several arrays of one store in a single pass.
+    // Chunks of all arrays are interleaved on one worker team, so reading
+    // one array overlaps decompressing the others.
+    static ZarrGroup
+    load_group(const std::string& store_path,
+               const std::vector<std::string>& float_arrays,
+               const std::vector<std::string>& string_arrays,
+               const std::vector<std::string>& hour_arrays = {},
+               unsigned int num_threads = 0,  // 0 = auto-detect
+               LoadStats* stats = nullptr);
+
+    // Decode the store chunk by chunk without materializing whole arrays.
+    // fn runs on the worker that decoded the chunk; chunks arrive in no
+    // particular order and concurrently on different workers.
+    static void
+    stream_chunks(const std::string& store_path,
+                  const std::vector<std::string>& float_arrays,
+                  const std::vector<std::string>& hour_arrays,
+                  const ChunkCallback& fn,
+                  unsigned int num_threads = 0,  // 0 = auto-detect
+                  LoadStats* stats = nullptr);
 };
@@ -11,15 +11,25 @@
 #include "builder/parallel_simple_cube_builder.h"
 #include "cube/datacube.h"
 #include "cube/simple_cube.h"
+#include "cube/time_axis.h"
+#include "cube/cube_view.h"
 #include "loader/zarr_loader.h"
+#include "loader/cube_file.h"
 #include "olap/operations.h"
 #include "olap/simple_operations.h"
 #include "olap/parallel_operations.h"
 #include "olap/omp_operations.h"
+#include "olap/dispatch.h"
+#include "olap/calendar_operations.h"
 #include "utils/timer.h"
 #include "builder/omp_sc_builder.h"
+#include "builder/streaming_cube_builder.h"
 
 #include "benchmark/benchmark_runner.h"
+#include "benchmark/builder_benchmarks.h"
+#include "benchmark/layout_benchmarks.h"
+#include "benchmark/pool_benchmarks.h"
+#include "benchmark/reduce_benchmarks.h"
 
 #include <chrono>
 #include <fstream>
@@ -79,7 +89,7 @@ void run_datacube(Datacube<float>& cube)
             {
                 for (size_t lon = 0; lon < LON; ++lon)
                 {
-                    file << slice[lat * LON + lon];
+                    file << slice.at(0, lat, lon);
 
                     if (lon != LON - 1)
                         file << ",";
@@ -118,7 +128,7 @@ void run_datacube(Datacube<float>& cube)
                 {
                     std::cout << std::fixed
                               << std::setprecision(2)
-                              << slice[i * LON + j] << " ";
+                              << slice.at(0, i, j) << " ";
                 }
                 std::cout << "\n";
             }
@@ -150,17 +160,32 @@ void run_datacube(Datacube<float>& cube)
     }
 }
 
-void run_simplecube(SimpleCube<float>& cube, Timer& timer)
+void run_simplecube(CubeView<float> cube, const TimeAxis& axis, Timer& timer,
+                    const ValidityMask* valid = nullptr,
+                    const CubeView<int32_t>* counts = nullptr)
 {
     std::string cmd;
 
+    auto c0 = Timer::now();
+    const CostModel& costs = CostModel::instance();
+    auto c1 = Timer::now();
+
+    CubeDispatcher<float> dispatcher(cube, costs);
+    dispatcher.set_validity(valid);
+
     std::cout << "\n=== OLAP Console (SimpleCube) ===\n";
     std::cout << "Cube Dimensions: "
               << cube.time_dim() << " (time) × "
               << cube.lat_dim() << " (lat) × "
               << cube.lon_dim() << " (lon)\n";
     std::cout << "Geographic Coverage: Lat [5°N-40°N], Lon [65°E-100°E]\n";
-    std::cout << "Resolution: 0.25°\n\n";
+    std::cout << "Resolution: 0.25°\n";
+    if (valid)
+        std::cout << "Observed cells: " << valid->count()
+                  << " (means skip empty cells)\n";
+    std::cout << "Backend cost model: " << costs.max_threads() << " threads, ready in "
+              << Timer::elapsed(c0, c1) * 1e3 << " ms\n";
+    std::cout << "\n";
 
     std::cout << "Commands:\n";
     std::cout << "1  global_mean\n";
@@ -173,7 +198,15 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
     std::cout << "8  export_slice <t>         (example: export_slice 0)\n";
     std::cout << "9  export_timing_summary\n";
     std::cout << "10 info                     (show cube stats)\n";
-    std::cout << "11 exit\n\n";
+    std::cout << "11 exit\n";
+    std::cout << "   time <t>                 (example: time 0)\n";
+    std::cout << "   time_index <YYYY-MM-DDTHH>  (example: time_index 2024-06-01T03)\n";
+    std::cout << "   timeseries <lat> <lon>   (example: timeseries 60 70)\n";
+    std::cout << "   region_timeseries <lat1> <lat2> <lon1> <lon2>  (example: region_timeseries 60 64 70 74)\n";
+    std::cout << "   build_pixel_major | build_tiled | build_index | drop_layouts | layouts\n";
+    std::cout << "   explain <command>        (example: explain region_mean 0 5 0 20 0 20)\n";
+    std::cout << "   calendar <day|month|season|hour>  (example: calendar day)\n";
+    std::cout << "   save <path>              (example: save gpm_2024.gpmcube)\n\n";
 
     while (true)
     {
@@ -186,7 +219,7 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
         else if (cmd == "global_mean" || cmd == "1")
         {
             auto t0 = Timer::now();
-            float val = simple_olap::global_mean(cube);
+            float val = dispatcher.global_mean();
             auto t1 = Timer::now();
             timer.record("global_mean", Timer::elapsed(t0, t1));
             std::cout << "Global Mean: " << val << "\n";
@@ -194,10 +227,11 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
         else if (cmd == "rollup_time_sum" || cmd == "2")
         {
             auto t0 = Timer::now();
-            auto rolled = simple_olap::rollup_time_sum(cube);
+            auto rolled = dispatcher.rollup_time_sum();
             auto t1 = Timer::now();
             timer.record("rollup_time_sum", Timer::elapsed(t0, t1));
-            std::cout << "Rolled up (sum) over time.\n";
+            std::cout << "Rolled up (sum) over time ("
+                      << dispatcher.layout_name(dispatcher.time_layout()) << ").\n";
             std::cout << "Result dims: "
                       << rolled.time_dim() << " × "
                       << rolled.lat_dim() << " × "
@@ -206,10 +240,11 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
         else if (cmd == "rollup_time_mean" || cmd == "3")
         {
             auto t0 = Timer::now();
-            auto rolled = simple_olap::rollup_time_mean(cube);
+            auto rolled = dispatcher.rollup_time_mean();
             auto t1 = Timer::now();
             timer.record("rollup_time_mean", Timer::elapsed(t0, t1));
-            std::cout << "Rolled up (mean) over time.\n";
+            std::cout << "Rolled up (mean) over time ("
+                      << dispatcher.layout_name(dispatcher.time_layout()) << ").\n";
             std::cout << "Result dims: "
                       << rolled.time_dim() << " × "
                       << rolled.lat_dim() << " × "
@@ -232,11 +267,12 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
             }
 
             auto t0 = Timer::now();
-            auto slice = simple_olap::slice_time(cube, t);
+            auto slice = dispatcher.slice_time(t);
             auto t1 = Timer::now();
             timer.record("slice_time", Timer::elapsed(t0, t1));
 
-            std::cout << "Slice at time " << t << "\n";
+            std::cout << "Slice at time " << t
+                      << " (" << axis.datetime(t) << ")\n";
             std::cout << "Lat × Lon grid:\n";
 
             size_t LAT = cube.lat_dim();
@@ -253,6 +289,246 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
                 std::cout << "\n";
             }
         }
+        else if (cmd.rfind("timeseries", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp;
+            size_t lat, lon;
+            iss >> temp >> lat >> lon;
+
+            if (!iss || lat >= cube.lat_dim() || lon >= cube.lon_dim())
+            {
+                std::cout << "Invalid pixel\n";
+                continue;
+            }
+
+            auto t0 = Timer::now();
+            auto series = dispatcher.timeseries(lat, lon);
+            auto t1 = Timer::now();
+            timer.record("timeseries", Timer::elapsed(t0, t1));
+
+            std::cout << "Hourly series at (" << lat << ", " << lon << ") via "
+                      << dispatcher.layout_name(dispatcher.series_layout()) << ":\n";
+            for (size_t t = 0; t < series.size(); ++t)
+                std::cout << axis.datetime(t) << "  " << series[t] << "\n";
+        }
+        else if (cmd.rfind("region_timeseries", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp;
+            size_t lat_start, lat_end, lon_start, lon_end;
+            iss >> temp >> lat_start >> lat_end >> lon_start >> lon_end;
+
+            if (!iss || lat_end > cube.lat_dim() || lon_end > cube.lon_dim() ||
+                lat_start >= lat_end || lon_start >= lon_end)
+            {
+                std::cout << "Invalid region\n";
+                continue;
+            }
+
+            auto t0 = Timer::now();
+            auto series = dispatcher.region_timeseries(lat_start, lat_end, lon_start, lon_end);
+            auto t1 = Timer::now();
+            timer.record("region_timeseries", Timer::elapsed(t0, t1));
+
+            std::cout << "Hourly box mean:\n";
+            for (size_t t = 0; t < series.size(); ++t)
+                std::cout << axis.datetime(t) << "  " << series[t] << "\n";
+        }
+        else if (cmd.rfind("explain", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp, op;
+            iss >> temp >> op;
+
+            if (op == "slice_time" || op == "dice_time" || op == "dice_region" ||
+                op == "export_slice")
+            {
+                std::cout << op << ": CubeView over the row-major cube, O(1), no kernel runs\n";
+                continue;
+            }
+
+            OlapOp olap_op;
+            CubeBox box{0, cube.time_dim(), 0, cube.lat_dim(), 0, cube.lon_dim()};
+
+            if (op == "global_mean")
+                olap_op = OlapOp::GlobalMean;
+            else if (op == "rollup_time_sum")
+                olap_op = OlapOp::RollupTimeSum;
+            else if (op == "rollup_time_mean")
+                olap_op = OlapOp::RollupTimeMean;
+            else if (op == "region_mean")
+            {
+                olap_op = OlapOp::RegionMean;
+                iss >> box.t_start >> box.t_end >> box.lat_start >> box.lat_end
+                    >> box.lon_start >> box.lon_end;
+
+                if (!iss || box.empty() || box.t_end > cube.time_dim() ||
+                    box.lat_end > cube.lat_dim() || box.lon_end > cube.lon_dim())
+                {
+                    std::cout << "Invalid region\n";
+                    continue;
+                }
+            }
+            else
+            {
+                std::cout << "Usage: explain global_mean | rollup_time_sum | rollup_time_mean"
+                             " | region_mean <t1> <t2> <lat1> <lat2> <lon1> <lon2>\n";
+                continue;
+            }
+
+            auto plan = dispatcher.explain(olap_op, box);
+
+            std::cout << olap_op_name(plan.op) << ": " << plan.cells << " cells via "
+                      << plan.route << "\n";
+
+            if (!plan.cost_based)
+                continue;
+
+            const auto flags = std::cout.flags();
+            const auto precision = std::cout.precision();
+
+            for (const auto& e : plan.choice.candidates)
+            {
+                std::cout << "  " << (e.backend == plan.choice.best.backend ? "* " : "  ")
+                          << std::left << std::setw(14) << backend_name(e.backend)
+                          << std::setw(4) << e.threads << "threads  est "
+                          << std::fixed << std::setprecision(1)
+                          << e.seconds * 1e6 << " us\n";
+            }
+
+            std::cout.flags(flags);
+            std::cout.precision(precision);
+        }
+        else if (cmd.rfind("calendar", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp, name;
+            iss >> temp >> name;
+
+            calendar_olap::Period period;
+            if (!calendar_olap::parse_period(name, period))
+            {
+                std::cout << "Usage: calendar day | month | season | hour\n";
+                continue;
+            }
+
+            auto t0 = Timer::now();
+            auto groups = calendar_olap::group_by(axis, period);
+            auto rolled = counts ? calendar_olap::rollup_mean(cube, groups, *counts)
+                        : valid  ? calendar_olap::rollup_mean(cube, groups, *valid)
+                                 : calendar_olap::rollup_mean(cube, groups);
+            auto t1 = Timer::now();
+            timer.record(std::string("calendar_") + name, Timer::elapsed(t0, t1));
+
+            std::cout << groups.size() << " " << name << " groups, means weighted by "
+                      << (counts ? "observation counts" : valid ? "observed hours" : "hours")
+                      << " (" << Timer::elapsed(t0, t1) * 1e3 << " ms)\n";
+
+            const size_t plane = rolled.lat_dim() * rolled.lon_dim();
+            const size_t shown = std::min<size_t>(groups.size(), 24);
+
+            for (size_t g = 0; g < shown; ++g)
+            {
+                double sum = 0.0;
+                for (size_t i = 0; i < plane; ++i)
+                    sum += rolled.data()[g * plane + i];
+
+                std::cout << "  " << std::left << std::setw(12) << groups.labels[g]
+                          << std::setw(8) << groups.hours[g]
+                          << "domain mean " << sum / plane << "\n";
+            }
+            std::cout << std::right;
+            if (shown < groups.size())
+                std::cout << "  ... " << groups.size() - shown << " more\n";
+        }
+        else if (cmd == "build_pixel_major" || cmd == "build_tiled")
+        {
+            auto t0 = Timer::now();
+            if (cmd == "build_pixel_major")
+                dispatcher.build_pixel_major();
+            else
+                dispatcher.build_tiled();
+            auto t1 = Timer::now();
+            timer.record(cmd, Timer::elapsed(t0, t1));
+
+            std::cout << "Built in " << Timer::elapsed(t0, t1) << " s, secondary layouts use "
+                      << dispatcher.secondary_bytes() / (1024.0 * 1024.0) << " MiB\n";
+        }
+        else if (cmd == "build_index")
+        {
+            auto t0 = Timer::now();
+            dispatcher.build_prefix_index();
+            auto t1 = Timer::now();
+            timer.record(cmd, Timer::elapsed(t0, t1));
+
+            std::cout << "Prefix-sum index built in " << Timer::elapsed(t0, t1)
+                      << " s, region_mean is now O(1); secondary layouts use "
+                      << dispatcher.secondary_bytes() / (1024.0 * 1024.0) << " MiB\n";
+        }
+        else if (cmd.rfind("save", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp, out_path;
+            iss >> temp >> out_path;
+
+            if (out_path.empty())
+            {
+                std::cout << "Usage: save <path>\n";
+                continue;
+            }
+
+            auto t0 = Timer::now();
+            CubeFile::write(out_path, cube, axis, GridSpec(), nullptr, valid);
+            auto t1 = Timer::now();
+            timer.record("save_cube", Timer::elapsed(t0, t1));
+
+            std::cout << "Saved to " << out_path << " in " << Timer::elapsed(t0, t1) << " s\n";
+        }
+        else if (cmd == "drop_layouts")
+        {
+            dispatcher.drop_secondary();
+            std::cout << "Secondary layouts dropped\n";
+        }
+        else if (cmd == "layouts")
+        {
+            std::cout << "Resident: row-major"
+                      << (dispatcher.has_tiled() ? ", tiled" : "")
+                      << (dispatcher.has_pixel_major() ? ", pixel-major" : "")
+                      << (dispatcher.has_prefix_index() ? ", prefix index" : "") << "\n";
+            std::cout << "Time-axis reductions use "
+                      << dispatcher.layout_name(dispatcher.time_layout()) << "\n";
+        }
+        else if (cmd.rfind("time_index", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp, datetime;
+            iss >> temp >> datetime;
+
+            int32_t t = axis.index_of(datetime);
+            if (t < 0)
+            {
+                std::cout << "No time bin for " << datetime << "\n";
+                continue;
+            }
+
+            std::cout << datetime << " -> t = " << t << "\n";
+        }
+        else if (cmd.rfind("time", 0) == 0)
+        {
+            std::istringstream iss(cmd);
+            std::string temp;
+            size_t t;
+            iss >> temp >> t;
+
+            if (!iss || t >= axis.size())
+            {
+                std::cout << "Invalid time index\n";
+                continue;
+            }
+
+            std::cout << "t = " << t << " -> " << axis.datetime(t) << "\n";
+        }
         else if (cmd.rfind("dice_time", 0) == 0)
         {
             std::istringstream iss(cmd);
@@ -267,7 +543,7 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
             }
 
             auto t0 = Timer::now();
-            auto diced = simple_olap::dice_time(cube, t_start, t_end);
+            auto diced = dispatcher.dice(t_start, t_end, 0, cube.lat_dim(), 0, cube.lon_dim());
             auto t1 = Timer::now();
             timer.record("dice_time", Timer::elapsed(t0, t1));
 
@@ -291,7 +567,7 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
             }
 
             auto t0 = Timer::now();
-            auto diced = simple_olap::dice_region(cube, lat_start, lat_end, lon_start, lon_end);
+            auto diced = dispatcher.dice(0, cube.time_dim(), lat_start, lat_end, lon_start, lon_end);
             auto t1 = Timer::now();
             timer.record("dice_region", Timer::elapsed(t0, t1));
 
@@ -315,11 +591,12 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
             }
 
             auto t0 = Timer::now();
-            float val = simple_olap::region_mean(cube, t_start, t_end, lat_start, lat_end, lon_start, lon_end);
+            float val = dispatcher.region_mean(t_start, t_end, lat_start, lat_end, lon_start, lon_end);
             auto t1 = Timer::now();
             timer.record("region_mean", Timer::elapsed(t0, t1));
 
-            std::cout << "Region Mean: " << val << "\n";
+            std::cout << "Region Mean: " << val
+                      << (dispatcher.has_prefix_index() ? " (prefix index)" : "") << "\n";
         }
         else if (cmd.rfind("export_slice", 0) == 0)
         {
@@ -335,12 +612,13 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
             }
 
             auto t0 = Timer::now();
-            auto slice = simple_olap::slice_time(cube, t);
+            auto slice = dispatcher.slice_time(t);
             // export_simple_cube_csv(slice, 0, "slice_simple.csv");
             auto t1 = Timer::now();
             timer.record("slice_time", Timer::elapsed(t0, t1));
 
-            std::cout << "Exported slice to slice_simple.csv\n";
+            std::cout << "Slice " << t << ": " << slice.time_dim() << " × "
+                      << slice.lat_dim() << " × " << slice.lon_dim() << "\n";
         }
         else if (cmd == "export_timing_summary" || cmd == "9")
         {
@@ -356,7 +634,9 @@ void run_simplecube(SimpleCube<float>& cube, Timer& timer)
             std::cout << "Total cells: " << cube.time_dim() * cube.lat_dim() * cube.lon_dim() << "\n\n";
 
             std::cout << "Valid Query Ranges:\n";
-            std::cout << "  Time index (t):     0 to " << (cube.time_dim() - 1) << "\n";
+            std::cout << "  Time index (t):     0 to " << (cube.time_dim() - 1)
+                      << " (" << axis.datetime(0) << " to "
+                      << axis.datetime(axis.size() - 1) << ")\n";
             std::cout << "  Latitude index:     0 to " << (cube.lat_dim() - 1)
                       << " (maps to 5°N - 40°N)\n";
             std::cout << "  Longitude index:    0 to " << (cube.lon_dim() - 1)
@@ -388,7 +668,8 @@ void run_benchmark(
     const std::vector<float>& lat_data,
     const std::vector<float>& lon_data,
     const std::vector<float>& nsr_data,
-    const std::vector<std::string>& timestamp_data);
+    const std::vector<int32_t>& hour_data,
+    const TimeAxis& axis);
 
 void run_benchmark_generic(size_t T,size_t LAT,size_t LON);
 
@@ -409,13 +690,18 @@ int main(int argc,char** argv) {
     return 0;
 
     std::string path = "/media/muqeeth26832/KALI LINUX/GPM_DPR_India_2024.zarr/2D/";
+    std::string cube_path = "GPM_DPR_India_2024.gpmcube";
+    unsigned int loader_threads = 0; // 0 = auto-detect
 
     std::cout << "=== GPM Datacube Project ===\n";
     std::cout << "Select mode:\n";
     std::cout << "1. Datacube (flat vector storage)\n";
     std::cout << "2. SimpleCube (3D vector storage)\n";
-    std::cout << "3. Basic Benchmark (Datacube vs SimpleCube vs Parallel vs OMP)\n";
+    std::cout << "3. Basic Benchmark (Datacube vs SimpleCube vs Parallel vs OMP, row-major vs tiled)\n";
     std::cout << "4. No Actual data benchmarks\n";
+    std::cout << "5. Streaming SimpleCube (fused load + bin)\n";
+    std::cout << "6. Build cube and save to " << cube_path << "\n";
+    std::cout << "7. Open " << cube_path << " (mmap, no rebuild)\n";
     std::cout << "Choice: ";
 
     std::string choice;
@@ -428,28 +714,26 @@ int main(int argc,char** argv) {
         // Datacube version
         auto t0 = std::chrono::high_resolution_clock::now();
 
-        auto nsr_data = ZarrLoader::load_float_array(path + "nsr");
+        LoadStats load_stats;
+        auto group = ZarrLoader::load_group(
+            path, {"nsr", "lat", "lon"}, {}, {"timestamps"},
+            loader_threads, &load_stats);
         auto t1 = std::chrono::high_resolution_clock::now();
 
-        auto lat_data = ZarrLoader::load_float_array(path + "lat");
-        auto t2 = std::chrono::high_resolution_clock::now();
-
-        auto lon_data = ZarrLoader::load_float_array(path + "lon");
-        auto t3 = std::chrono::high_resolution_clock::now();
-
-        auto timestamp_data = ZarrLoader::load_string_array(path + "timestamps");
-        auto t4 = std::chrono::high_resolution_clock::now();
+        const auto& nsr_data = group.floats["nsr"];
+        const auto& lat_data = group.floats["lat"];
+        const auto& lon_data = group.floats["lon"];
+        const auto& hour_data = group.hours["timestamps"];
 
         auto dur = [](auto start, auto end) {
             return std::chrono::duration<double>(end - start).count();
         };
 
         std::cout << "\n=== Loading Time Analytics ===\n";
-        std::cout << "NSR load time: " << dur(t0, t1) << " sec\n";
-        std::cout << "LAT load time: " << dur(t1, t2) << " sec\n";
-        std::cout << "LON load time: " << dur(t2, t3) << " sec\n";
-        std::cout << "Timestamp load time: " << dur(t3, t4) << " sec\n";
-        std::cout << "Total load time: " << dur(t0, t4) << " sec\n";
+        std::cout << "Total load time: " << dur(t0, t1) << " sec\n";
+        load_stats.print(std::cout, "nsr/lat/lon/timestamps");
+
+        TimeAxis axis = TimeAxis::from_hours(hour_data);
 
 
         std::cout << "\nBuilding default cube...\n";
@@ -458,7 +742,8 @@ int main(int argc,char** argv) {
             lat_data,
             lon_data,
             nsr_data,
-            timestamp_data);
+            hour_data,
+            axis);
         auto tcube1 = std::chrono::high_resolution_clock::now();
         std::cout << "Total build time: " << dur(tcube0, tcube1) << " sec\n";
         std::cout << "Cube ready.\n";
@@ -470,64 +755,175 @@ int main(int argc,char** argv) {
         // Basic benchmark mode
         std::cout << "\nLoading data for benchmark...\n";
 
-        auto nsr_data = ZarrLoader::load_float_array(path + "nsr");
-        auto lat_data = ZarrLoader::load_float_array(path + "lat");
-        auto lon_data = ZarrLoader::load_float_array(path + "lon");
-        auto timestamp_data = ZarrLoader::load_string_array(path + "timestamps");
-
-        run_benchmark(lat_data, lon_data, nsr_data, timestamp_data);
+        auto group = ZarrLoader::load_group(
+            path, {"nsr", "lat", "lon"}, {}, {"timestamps"}, loader_threads);
+
+        const auto& nsr_data = group.floats["nsr"];
+        const auto& lat_data = group.floats["lat"];
+        const auto& lon_data = group.floats["lon"];
+        const auto& hour_data = group.hours["timestamps"];
+        TimeAxis axis = TimeAxis::from_hours(hour_data);
+
+        run_benchmark(lat_data, lon_data, nsr_data, hour_data, axis);
+        benchmark::run_accumulation_comparison(lat_data, lon_data, nsr_data, hour_data, axis);
+        benchmark::run_builder_scaling(lat_data, lon_data, nsr_data, hour_data, axis);
+        benchmark::run_measure_overhead(lat_data, lon_data, nsr_data, hour_data, axis);
+        auto omp_cube = OMPSimpleCubeBuilder::build(lat_data, lon_data, nsr_data, hour_data, axis);
+        benchmark::run_layout_comparison(omp_cube);
+        benchmark::run_sparse_comparison(omp_cube);
+        benchmark::run_quantized_comparison(omp_cube);
+        benchmark::run_pool_overhead_comparison(omp_cube);
+        benchmark::run_reduce_fusion_comparison(omp_cube);
     }
     else if(choice=="4")
     {
         std::cout<<"BENCHMARKS....\n";
         benchmark::run_benchmark_generic(586, 140,140);
     }
-    else
+    else if (choice == "5")
     {
-        // SimpleCube version
-        auto t0 = std::chrono::high_resolution_clock::now();
+        // Streaming version: chunks are binned as they are decoded,
+        // the full arrays are never held in memory
+        auto dur = [](auto start, auto end) {
+            return std::chrono::duration<double>(end - start).count();
+        };
 
-        auto nsr_data = ZarrLoader::load_float_array(path + "nsr");
+        auto t0 = std::chrono::high_resolution_clock::now();
+        TimeAxis axis = StreamingCubeBuilder::scan_time_axis(path, loader_threads);
         auto t1 = std::chrono::high_resolution_clock::now();
-        timer.record("load_nsr", std::chrono::duration<double>(t1 - t0).count());
+        timer.record("scan_time_axis", dur(t0, t1));
+
+        if (axis.size() > 0)
+            std::cout << "Time axis: " << axis.size() << " hours, "
+                      << axis.datetime(0) << " to "
+                      << axis.datetime(axis.size() - 1) << "\n";
 
-        auto lat_data = ZarrLoader::load_float_array(path + "lat");
+        LoadStats load_stats;
+        ValidityMask valid;
+        auto cube = StreamingCubeBuilder::build(path, axis, loader_threads, &load_stats, &valid);
         auto t2 = std::chrono::high_resolution_clock::now();
-        timer.record("load_lat", std::chrono::duration<double>(t2 - t1).count());
+        timer.record("stream_build_cube", dur(t1, t2));
 
-        auto lon_data = ZarrLoader::load_float_array(path + "lon");
-        auto t3 = std::chrono::high_resolution_clock::now();
-        timer.record("load_lon", std::chrono::duration<double>(t3 - t2).count());
+        std::cout << "Time axis scan: " << dur(t0, t1) << " sec\n";
+        std::cout << "Fused load + build: " << dur(t1, t2) << " sec\n";
+        load_stats.print(std::cout, "nsr/lat/lon/timestamps");
+        std::cout << "SimpleCube ready.\n";
 
-        auto timestamp_data = ZarrLoader::load_string_array(path + "timestamps");
-        auto t4 = std::chrono::high_resolution_clock::now();
-        timer.record("load_timestamps", std::chrono::duration<double>(t4 - t3).count());
+        run_simplecube(cube, axis, timer, &valid);
+
+        timer.export_csv("timing_raw.csv");
+        timer.export_summary_csv("timing_summary.csv");
+        std::cout << "\nTiming data exported to timing_raw.csv and timing_summary.csv\n";
+    }
+    else if (choice == "6")
+    {
+        // Build once with counts and write the native cube file
+        auto group = ZarrLoader::load_group(
+            path, {"nsr", "lat", "lon"}, {}, {"timestamps"}, loader_threads);
+
+        const auto& hour_data = group.hours["timestamps"];
+        TimeAxis axis = TimeAxis::from_hours(hour_data);
+
+        SimpleCube<int> counts(0, 0, 0);
+        ValidityMask valid;
+        auto cube = OMPSimpleCubeBuilder::build(
+            group.floats["lat"], group.floats["lon"], group.floats["nsr"],
+            hour_data, axis, 0, &counts, &valid);
+
+        auto t0 = Timer::now();
+        CubeFile::write(cube_path, cube, axis, GridSpec(), &counts, &valid);
+        auto t1 = Timer::now();
+
+        std::cout << "Cube written to " << cube_path
+                  << " in " << Timer::elapsed(t0, t1) << " s\n";
+    }
+    else if (choice == "7")
+    {
+        // Map the saved cube read-only and query it in place
+        auto t0 = Timer::now();
+        MappedCube mapped(cube_path);
+        auto t1 = Timer::now();
+        timer.record("open_cube", Timer::elapsed(t0, t1));
+
+        std::cout << "Mapped " << cube_path << " ("
+                  << mapped.file_size() / (1024.0 * 1024.0) << " MiB) in "
+                  << Timer::elapsed(t0, t1) * 1000.0 << " ms"
+                  << (mapped.has_count() ? ", with counts" : "") << "\n";
+
+        ValidityMask valid;
+        if (mapped.has_validity())
+            valid = mapped.validity();
+
+        const CubeView<int32_t> counts = mapped.has_count()
+            ? mapped.count() : CubeView<int32_t>(nullptr, 0, 0, 0, 0, 0);
+
+        // A partial-aggregate file holds sums: finalize to means first
+        SimpleCube<float> means(0, 0, 0);
+        if (mapped.holds_sums())
+        {
+            means = mapped.partial().finalize(&valid);
+            std::cout << "Partial aggregates finalized to means\n";
+        }
+
+        run_simplecube(mapped.holds_sums() ? CubeView<float>(means) : mapped.cube(),
+                       mapped.axis(), timer,
+                       mapped.has_validity() || mapped.holds_sums() ? &valid : nullptr,
+                       mapped.has_count() ? &counts : nullptr);
+
+        timer.export_csv("timing_raw.csv");
+        timer.export_summary_csv("timing_summary.csv");
+        std::cout << "\nTiming data exported to timing_raw.csv and timing_summary.csv\n";
+    }
+    else
+    {
+        // SimpleCube version
+        auto t0 = std::chrono::high_resolution_clock::now();
+
+        LoadStats load_stats;
+        auto group = ZarrLoader::load_group(
+            path, {"nsr", "lat", "lon"}, {}, {"timestamps"},
+            loader_threads, &load_stats);
+        auto t1 = std::chrono::high_resolution_clock::now();
+        timer.record("load_group", std::chrono::duration<double>(t1 - t0).count());
+
+        const auto& nsr_data = group.floats["nsr"];
+        const auto& lat_data = group.floats["lat"];
+        const auto& lon_data = group.floats["lon"];
+        const auto& hour_data = group.hours["timestamps"];
 
         auto dur = [](auto start, auto end) {
             return std::chrono::duration<double>(end - start).count();
         };
 
         std::cout << "\n=== Loading Time Analytics ===\n";
-        std::cout << "NSR load time: " << dur(t0, t1) << " sec\n";
-        std::cout << "LAT load time: " << dur(t1, t2) << " sec\n";
-        std::cout << "LON load time: " << dur(t2, t3) << " sec\n";
-        std::cout << "Timestamp load time: " << dur(t3, t4) << " sec\n";
-        std::cout << "Total load time: " << dur(t0, t4) << " sec\n";
+        std::cout << "Total load time: " << dur(t0, t1) << " sec\n";
+
+        std::cout << "\n=== Loader Balance ===\n";
+        load_stats.print(std::cout, "nsr/lat/lon/timestamps");
+
+        TimeAxis axis = TimeAxis::from_hours(hour_data);
+        if (axis.size() > 0)
+            std::cout << "Time axis: " << axis.size() << " hours, "
+                      << axis.datetime(0) << " to "
+                      << axis.datetime(axis.size() - 1) << "\n";
 
         std::cout << "\nBuilding simple cube...\n";
         auto tcube0 = std::chrono::high_resolution_clock::now();
+        ValidityMask valid;
         auto cube = SimpleCubeBuilder::build(
             lat_data,
             lon_data,
             nsr_data,
-            timestamp_data);
+            hour_data,
+            axis,
+            &valid);
         auto tcube1 = std::chrono::high_resolution_clock::now();
         double build_time = dur(tcube0, tcube1);
         timer.record("build_cube", build_time);
         std::cout << "Total build time: " << build_time << " sec\n";
         std::cout << "SimpleCube ready.\n";
 
-        run_simplecube(cube, timer);
+        run_simplecube(cube, axis, timer, &valid);
 
         // Export timing data on exit
         timer.export_csv("timing_raw.csv");
@@ -543,7 +939,8 @@ void run_benchmark(
     const std::vector<float>& lat_data,
     const std::vector<float>& lon_data,
     const std::vector<float>& nsr_data,
-    const std::vector<std::string>& timestamp_data)
+    const std::vector<int32_t>& hour_data,
+    const TimeAxis& axis)
 {
     std::cout << "\n=== Benchmark: Datacube vs SimpleCube vs Thread vs OpenMP ===\n\n";
 
@@ -569,16 +966,16 @@ void run_benchmark(
     std::cout << "Building cubes...\n";
 
     auto t0 = Timer::now();
-    auto dc_cube = DefaultCubeBuilder::build(lat_data, lon_data, nsr_data, timestamp_data);
+    auto dc_cube = DefaultCubeBuilder::build(lat_data, lon_data, nsr_data, hour_data, axis);
     auto t1 = Timer::now();
 
-    auto seq_cube = SimpleCubeBuilder::build(lat_data, lon_data, nsr_data, timestamp_data);
+    auto seq_cube = SimpleCubeBuilder::build(lat_data, lon_data, nsr_data, hour_data, axis);
     auto t2 = Timer::now();
 
-    auto thread_cube = ParallelSimpleCubeBuilder::build(lat_data, lon_data, nsr_data, timestamp_data);
+    auto thread_cube = ParallelSimpleCubeBuilder::build(lat_data, lon_data, nsr_data, hour_data, axis);
     auto t3 = Timer::now();
 
-    auto omp_cube = OMPSimpleCubeBuilder::build(lat_data, lon_data, nsr_data, timestamp_data);
+    auto omp_cube = OMPSimpleCubeBuilder::build(lat_data, lon_data, nsr_data, hour_data, axis);
     auto t4 = Timer::now();
 
     double dc_build = Timer::elapsed(t0,t1);
@@ -620,18 +1017,23 @@ void run_benchmark(
     size_t slice_t = 0;
 
     auto s0 = Timer::now();
-    auto dc_slice = olap::slice_time(dc_cube, slice_t);
+    auto dc_slice = olap::slice_time(dc_cube, slice_t).materialize<SimpleCube<float>>();
     auto s1 = Timer::now();
 
-    auto seq_slice = simple_olap::slice_time(seq_cube, slice_t);
+    auto seq_slice = simple_olap::slice_time(seq_cube, slice_t).materialize<SimpleCube<float>>();
     auto s2 = Timer::now();
 
-    auto thread_slice = parallel_olap::slice_time(thread_cube, slice_t);
+    auto thread_slice = parallel_olap::slice_time(thread_cube, slice_t).materialize<SimpleCube<float>>();
     auto s3 = Timer::now();
 
-    auto omp_slice = omp_olap::slice_time(omp_cube, slice_t);
+    auto omp_slice = omp_olap::slice_time(omp_cube, slice_t).materialize<SimpleCube<float>>();
     auto s4 = Timer::now();
 
+    // Views are O(1); each slice is copied out so real work is timed
+    if (dc_slice.at(0, 0, 0) != omp_slice.at(0, 0, 0) ||
+        seq_slice.at(0, 0, 0) != thread_slice.at(0, 0, 0))
+        std::cout << "  slice_time: backends disagree\n";
+
     double dc_slice_t = Timer::elapsed(s0,s1);
     double seq_slice_t = Timer::elapsed(s1,s2);
     double thread_slice_t = Timer::elapsed(s2,s3);
@@ -658,18 +1060,21 @@ void run_benchmark(
     size_t t_end = std::min((size_t)10, dc_cube.time_dim());
 
     auto d0 = Timer::now();
-    auto dc_dice = olap::dice_time(dc_cube,t_start,t_end);
+    auto dc_dice = olap::dice_time(dc_cube,t_start,t_end).materialize<SimpleCube<float>>();
     auto d1 = Timer::now();
 
-    auto seq_dice = simple_olap::dice_time(seq_cube,t_start,t_end);
+    auto seq_dice = simple_olap::dice_time(seq_cube,t_start,t_end).materialize<SimpleCube<float>>();
     auto d2 = Timer::now();
 
-    auto thread_dice = parallel_olap::dice_time(thread_cube,t_start,t_end);
+    auto thread_dice = parallel_olap::dice_time(thread_cube,t_start,t_end).materialize<SimpleCube<float>>();
     auto d3 = Timer::now();
 
-    auto omp_dice = omp_olap::dice_time(omp_cube,t_start,t_end);
+    auto omp_dice = omp_olap::dice_time(omp_cube,t_start,t_end).materialize<SimpleCube<float>>();
     auto d4 = Timer::now();
 
+    if (dc_dice.size() != omp_dice.size() || seq_dice.size() != thread_dice.size())
+        std::cout << "  dice_time: backends disagree\n";
+
     double dc_dice_t = Timer::elapsed(d0,d1);
     double seq_dice_t = Timer::elapsed(d1,d2);
     double thread_dice_t = Timer::elapsed(d2,d3);
@@ -0,0 +1,295 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/time_axis.h"
+#include "../cube/validity_mask.h"
+#include "../utils/time_utils.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Rollups of the hourly time axis to calendar periods. group_by() maps
+// every t of a TimeAxis to a group; the rollups then produce a cube with
+// one time slice per group in a single pass: each thread owns a range of
+// lat rows and walks every hour once, adding the row into its group's
+// slice, so no two threads ever write the same output.
+//
+// Day and Month are chronological ("2024-06-01", "2024-06"). Season
+// (DJF, MAM, JJA, SON) and HourOfDay ("00".."23") are climatological and
+// pool every year on the axis. Only periods with at least one hour on
+// the axis get a group, in ascending order.
+namespace calendar_olap {
+
+enum class Period { Day, Month, Season, HourOfDay };
+
+inline const char* period_name(Period period)
+{
+    switch (period) {
+        case Period::Day:       return "day";
+        case Period::Month:     return "month";
+        case Period::Season:    return "season";
+        case Period::HourOfDay: return "hour";
+    }
+    return "unknown";
+}
+
+// "day" | "month" | "season" | "hour" -> period, false if unknown
+inline bool parse_period(const std::string& name, Period& period)
+{
+    for (Period p : {Period::Day, Period::Month, Period::Season, Period::HourOfDay})
+        if (name == period_name(p)) {
+            period = p;
+            return true;
+        }
+    return false;
+}
+
+struct Groups {
+    Period period = Period::Day;
+    std::vector<int32_t> group;          // t -> group
+    std::vector<std::string> labels;     // group -> label
+    std::vector<int32_t> hours;          // group -> time bins in it
+
+    size_t size() const { return labels.size(); }
+};
+
+// Calendar key of an epoch hour; ascending keys are ascending periods
+inline int64_t period_key(int32_t hour, Period period)
+{
+    if (period == Period::HourOfDay)
+        return timeutil::hour_of_day(hour);
+    if (period == Period::Day)
+        return timeutil::day_of(hour);
+
+    int y;
+    unsigned m, d;
+    timeutil::civil_from_days(timeutil::day_of(hour), y, m, d);
+
+    if (period == Period::Month)
+        return static_cast<int64_t>(y) * 12 + (m - 1);
+    return (m % 12) / 3;                 // DJF = 0 ... SON = 3
+}
+
+inline std::string period_label(int64_t key, Period period)
+{
+    static const char* seasons[] = {"DJF", "MAM", "JJA", "SON"};
+    char buf[32];
+
+    switch (period) {
+        case Period::Day: {
+            int y;
+            unsigned m, d;
+            timeutil::civil_from_days(key, y, m, d);
+            std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u", y, m, d);
+            break;
+        }
+        case Period::Month: {
+            const int64_t y = key >= 0 ? key / 12 : (key - 11) / 12;
+            std::snprintf(buf, sizeof(buf), "%04d-%02d",
+                          static_cast<int>(y), static_cast<int>(key - y * 12 + 1));
+            break;
+        }
+        case Period::Season:
+            return seasons[key];
+        case Period::HourOfDay:
+            std::snprintf(buf, sizeof(buf), "%02d", static_cast<int>(key));
+            break;
+    }
+    return buf;
+}
+
+inline Groups group_by(const TimeAxis& axis, Period period)
+{
+    Groups groups;
+    groups.period = period;
+
+    const size_t T = axis.size();
+    std::vector<int64_t> keys(T);
+    for (size_t t = 0; t < T; ++t)
+        keys[t] = period_key(axis.hour(t), period);
+
+    std::vector<int64_t> distinct = keys;
+    std::sort(distinct.begin(), distinct.end());
+    distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+    groups.group.resize(T);
+    groups.hours.assign(distinct.size(), 0);
+    for (size_t t = 0; t < T; ++t) {
+        const auto g = std::lower_bound(distinct.begin(), distinct.end(), keys[t]) - distinct.begin();
+        groups.group[t] = static_cast<int32_t>(g);
+        ++groups.hours[g];
+    }
+
+    groups.labels.reserve(distinct.size());
+    for (int64_t key : distinct)
+        groups.labels.push_back(period_label(key, period));
+
+    return groups;
+}
+
+namespace detail {
+
+    inline void check(size_t T, const Groups& groups)
+    {
+        if (T != groups.group.size())
+            throw std::invalid_argument("calendar_olap: cube and time groups have different lengths");
+    }
+
+    // sum.row(g, lat) += cube.row(t, lat) for every t of group g, and
+    // count.row(g, lat) += weight(t, lat, ...) when count is given.
+    // add(t, lat, src, sum_row, count_row) updates one row.
+    template<typename Cube, typename Dtype, typename Add>
+    void accumulate(const Cube& cube, const Groups& groups,
+                    SimpleCube<Dtype>& sum, SimpleCube<int32_t>* count, Add&& add)
+    {
+        const size_t T = cube.time_dim();
+        const size_t LAT = cube.lat_dim();
+
+        #pragma omp parallel for schedule(static)
+        for (size_t lat = 0; lat < LAT; ++lat)
+            for (size_t t = 0; t < T; ++t)
+            {
+                const size_t g = static_cast<size_t>(groups.group[t]);
+                add(t, lat, cube.row(t, lat), sum.row(g, lat),
+                    count ? count->row(g, lat) : nullptr);
+            }
+    }
+
+    // sum /= count cell by cell, 0 where nothing was observed
+    template<typename Dtype>
+    void divide(SimpleCube<Dtype>& sum, const SimpleCube<int32_t>& count)
+    {
+        Dtype* s = sum.data();
+        const int32_t* c = count.data();
+        const int64_t n = static_cast<int64_t>(sum.size());
+
+        #pragma omp parallel for simd schedule(static)
+        for (int64_t i = 0; i < n; ++i)
+            s[i] = c[i] > 0 ? s[i] / static_cast<Dtype>(c[i]) : Dtype(0);
+    }
+
+} // namespace detail
+
+//////////////////////////////////////////////////////////////
+// ROLLUP SUM
+//////////////////////////////////////////////////////////////
+
+// Per-group totals, e.g. daily accumulations of hourly rates
+template<typename Cube, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_sum(const Cube& cube, const Groups& groups)
+{
+    detail::check(cube.time_dim(), groups);
+
+    const size_t LON = cube.lon_dim();
+    SimpleCube<Dtype> sum(groups.size(), cube.lat_dim(), LON);
+
+    detail::accumulate(cube, groups, sum, nullptr,
+        [&](size_t, size_t, const Dtype* src, Dtype* acc, int32_t*) {
+            #pragma omp simd
+            for (size_t lon = 0; lon < LON; ++lon)
+                acc[lon] += src[lon];
+        });
+
+    return sum;
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP MEAN
+//////////////////////////////////////////////////////////////
+
+// Every time bin of a group weighted equally
+template<typename Cube, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_mean(const Cube& cube, const Groups& groups)
+{
+    SimpleCube<Dtype> mean = rollup_sum(cube, groups);
+    const size_t plane = cube.lat_dim() * cube.lon_dim();
+
+    for (size_t g = 0; g < groups.size(); ++g)
+    {
+        Dtype* m = mean.data() + g * plane;
+        const Dtype hours = static_cast<Dtype>(groups.hours[g]);
+
+        #pragma omp simd
+        for (size_t i = 0; i < plane; ++i)
+            m[i] /= hours;
+    }
+
+    return mean;
+}
+
+// Mean over the observations of each group: every hourly value is
+// weighted by its observation count, so a cell-hour with many samples
+// counts for more than one with a single sample. counts is a cube of the
+// same shape as cube (e.g. the builders' per-cell counts). group_count,
+// if given, receives the observations behind each output cell.
+template<typename Cube, typename Counts, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_mean(const Cube& cube, const Groups& groups,
+                              const Counts& counts,
+                              SimpleCube<int32_t>* group_count = nullptr)
+{
+    detail::check(cube.time_dim(), groups);
+    if (counts.time_dim() != cube.time_dim() || counts.lat_dim() != cube.lat_dim() ||
+        counts.lon_dim() != cube.lon_dim())
+        throw std::invalid_argument("calendar_olap: counts shape differs from the cube");
+
+    const size_t LON = cube.lon_dim();
+    SimpleCube<Dtype> mean(groups.size(), cube.lat_dim(), LON);
+    SimpleCube<int32_t> count(groups.size(), cube.lat_dim(), LON);
+
+    detail::accumulate(cube, groups, mean, &count,
+        [&](size_t t, size_t lat, const Dtype* src, Dtype* acc, int32_t* n) {
+            const auto* c = counts.row(t, lat);
+
+            #pragma omp simd
+            for (size_t lon = 0; lon < LON; ++lon) {
+                acc[lon] += src[lon] * static_cast<Dtype>(c[lon]);
+                n[lon] += static_cast<int32_t>(c[lon]);
+            }
+        });
+
+    detail::divide(mean, count);
+    if (group_count)
+        *group_count = std::move(count);
+    return mean;
+}
+
+// Mean over the observed hours of each group: empty cells (value 0,
+// bit clear) are left out of both the sum and the divisor
+template<typename Cube, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_mean(const Cube& cube, const Groups& groups,
+                              const ValidityMask& valid,
+                              SimpleCube<int32_t>* group_count = nullptr)
+{
+    detail::check(cube.time_dim(), groups);
+    if (valid.time_dim() != cube.time_dim() || valid.lat_dim() != cube.lat_dim() ||
+        valid.lon_dim() != cube.lon_dim())
+        throw std::invalid_argument("calendar_olap: validity mask shape differs from the cube");
+
+    const size_t LON = cube.lon_dim();
+    const size_t words = valid.words_per_row();
+    SimpleCube<Dtype> mean(groups.size(), cube.lat_dim(), LON);
+    SimpleCube<int32_t> count(groups.size(), cube.lat_dim(), LON);
+
+    detail::accumulate(cube, groups, mean, &count,
+        [&](size_t t, size_t lat, const Dtype* src, Dtype* acc, int32_t* n) {
+            #pragma omp simd
+            for (size_t lon = 0; lon < LON; ++lon)
+                acc[lon] += src[lon];
+
+            const uint64_t* bits = valid.row(t, lat);
+            for (size_t w = 0; w < words; ++w)
+                for (uint64_t word = bits[w]; word; word &= word - 1)
+                    ++n[w * 64 + ctz64(word)];
+        });
+
+    detail::divide(mean, count);
+    if (group_count)
+        *group_count = std::move(count);
+    return mean;
+}
+
+} // namespace calendar_olap
@@ -0,0 +1,275 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/cube_view.h"
+#include "../cube/prefix_sum_index.h"
+#include "../utils/thread_pool.h"
+#include "../utils/timer.h"
+#include "simple_operations.h"
+#include "parallel_operations.h"
+#include "omp_operations.h"
+#include <omp.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// Row-major kernel families that compute the same aggregates
+enum class Backend { Sequential, Threads, OpenMP };
+
+inline const char* backend_name(Backend backend)
+{
+    switch (backend) {
+        case Backend::Sequential: return "simple_olap";
+        case Backend::Threads:    return "parallel_olap";
+        case Backend::OpenMP:     return "omp_olap";
+    }
+    return "unknown";
+}
+
+enum class OlapOp { GlobalMean, RegionMean, RollupTimeSum, RollupTimeMean };
+
+inline const char* olap_op_name(OlapOp op)
+{
+    switch (op) {
+        case OlapOp::GlobalMean:     return "global_mean";
+        case OlapOp::RegionMean:     return "region_mean";
+        case OlapOp::RollupTimeSum:  return "rollup_time_sum";
+        case OlapOp::RollupTimeMean: return "rollup_time_mean";
+    }
+    return "unknown";
+}
+
+struct BackendEstimate {
+    Backend backend = Backend::Sequential;
+    unsigned int threads = 1;
+    double seconds = 0.0;      // predicted wall time
+};
+
+struct BackendChoice {
+    BackendEstimate best;
+    std::array<BackendEstimate, 3> candidates;   // indexed by Backend
+};
+
+// Runs one aggregate on the chosen backend and thread count
+namespace backend_olap {
+
+    // omp_set_num_threads for the lifetime of the scope; a no-op when
+    // built without OpenMP, where the pragmas run serially anyway
+    class OmpThreads {
+#if defined(_OPENMP)
+        int saved;
+    public:
+        explicit OmpThreads(unsigned int n) : saved(omp_get_max_threads()) {
+            omp_set_num_threads(static_cast<int>(n));
+        }
+        ~OmpThreads() { omp_set_num_threads(saved); }
+#else
+    public:
+        explicit OmpThreads(unsigned int) {}
+#endif
+    };
+
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype region_mean(const Cube& cube, const CubeBox& b, const BackendEstimate& on) {
+        switch (on.backend) {
+            case Backend::Sequential:
+                return simple_olap::region_mean(cube, b.t_start, b.t_end,
+                                                b.lat_start, b.lat_end, b.lon_start, b.lon_end);
+            case Backend::Threads:
+                return parallel_olap::region_mean(cube, b.t_start, b.t_end,
+                                                  b.lat_start, b.lat_end, b.lon_start, b.lon_end,
+                                                  on.threads);
+            default: {
+                OmpThreads scope(on.threads);
+                return omp_olap::region_mean(cube, b.t_start, b.t_end,
+                                             b.lat_start, b.lat_end, b.lon_start, b.lon_end);
+            }
+        }
+    }
+
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype global_mean(const Cube& cube, const BackendEstimate& on) {
+        switch (on.backend) {
+            case Backend::Sequential: return simple_olap::global_mean(cube);
+            case Backend::Threads:    return parallel_olap::global_mean(cube, on.threads);
+            default: {
+                OmpThreads scope(on.threads);
+                return omp_olap::global_mean(cube);
+            }
+        }
+    }
+
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    SimpleCube<Dtype> rollup_time_sum(const Cube& cube, const BackendEstimate& on) {
+        switch (on.backend) {
+            case Backend::Sequential: return simple_olap::rollup_time_sum(cube);
+            case Backend::Threads:    return parallel_olap::rollup_time_sum(cube, on.threads);
+            default: {
+                OmpThreads scope(on.threads);
+                return omp_olap::rollup_time_sum(cube);
+            }
+        }
+    }
+
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    SimpleCube<Dtype> rollup_time_mean(const Cube& cube, const BackendEstimate& on) {
+        switch (on.backend) {
+            case Backend::Sequential: return simple_olap::rollup_time_mean(cube);
+            case Backend::Threads:    return parallel_olap::rollup_time_mean(cube, on.threads);
+            default: {
+                OmpThreads scope(on.threads);
+                return omp_olap::rollup_time_mean(cube);
+            }
+        }
+    }
+
+} // namespace backend_olap
+
+// Linear cost model for picking a backend per query:
+// time = overhead + per_cell × cells read, per backend and kernel shape
+// (reductions to one value, rollups that write a lat × lon plane).
+// calibrate() measures both terms with a short micro-benchmark on a
+// synthetic cube; a default-constructed model has no costs and always
+// picks simple_olap.
+//
+// Parallel backends are measured at full width. For a given query they
+// get enough threads that each does at least one fork/join's worth of
+// sequential work (overhead / sequential per_cell cells), capped at the
+// calibrated width; the per-cell term is then scaled by width / threads
+// so the estimate is for the thread count that actually runs.
+class CostModel {
+public:
+    struct Cost {
+        double overhead = 0.0;   // seconds per call
+        double per_cell = 0.0;   // seconds per cell read
+
+        double predict(size_t cells) const { return overhead + per_cell * cells; }
+    };
+
+private:
+    std::array<std::array<Cost, 3>, 2> costs{};   // [reduction|rollup][Backend]
+    unsigned int width = 1;
+    double calibration_seconds = 0.0;
+
+    static int shape(OlapOp op) {
+        return (op == OlapOp::GlobalMean || op == OlapOp::RegionMean) ? 0 : 1;
+    }
+
+public:
+    CostModel() = default;
+
+    // threads: parallel width, 0 = ThreadPool size
+    static CostModel calibrate(unsigned int threads = 0)
+    {
+        auto start = Timer::now();
+
+        CostModel model;
+        model.width = threads ? threads : ThreadPool::instance().size();
+
+        // Small enough to stay in cache: the big case measures the
+        // per-cell term, the 16 × 16 tile the fixed one
+        SimpleCube<float> cube(32, 140, 140);
+        for (size_t i = 0; i < cube.size(); ++i)
+            cube.data()[i] = static_cast<float>(i % 13) * 0.1f;
+
+        const CubeView<float> big(cube);
+        const CubeView<float> small = big.sub(0, 1, 0, 16, 0, 16);
+        const double n_big = static_cast<double>(big.size());
+        const double n_small = static_cast<double>(small.size());
+
+        auto best_of = [](int runs, auto&& fn) {
+            double best = 0.0;
+            for (int r = 0; r < runs; r++) {
+                auto s = Timer::now();
+                fn();
+                double elapsed = Timer::elapsed(s, Timer::now());
+                best = (r == 0) ? elapsed : std::min(best, elapsed);
+            }
+            return best;
+        };
+
+        volatile float sink = 0.0f;
+
+        for (Backend b : {Backend::Sequential, Backend::Threads, Backend::OpenMP})
+        {
+            const BackendEstimate on{b, b == Backend::Sequential ? 1u : model.width, 0.0};
+
+            auto reduce = [&](const CubeView<float>& v) {
+                sink = backend_olap::global_mean(v, on);
+            };
+            auto rollup = [&](const CubeView<float>& v) {
+                sink = backend_olap::rollup_time_sum(v, on).data()[0];
+            };
+
+            auto fit = [&](double t_small, double t_big) {
+                Cost c;
+                c.per_cell = std::max(0.0, (t_big - t_small) / (n_big - n_small));
+                c.overhead = std::max(0.0, t_small - c.per_cell * n_small);
+                return c;
+            };
+
+            // warm-up: first touch, pool and OpenMP team start
+            reduce(big);
+            rollup(big);
+
+            model.costs[0][static_cast<int>(b)] = fit(
+                best_of(15, [&] { reduce(small); }), best_of(5, [&] { reduce(big); }));
+            model.costs[1][static_cast<int>(b)] = fit(
+                best_of(15, [&] { rollup(small); }), best_of(5, [&] { rollup(big); }));
+        }
+
+        model.calibration_seconds = Timer::elapsed(start, Timer::now());
+        return model;
+    }
+
+    // Calibrated once per process, on first use
+    static const CostModel& instance() {
+        static const CostModel model = calibrate();
+        return model;
+    }
+
+    void set(OlapOp op, Backend backend, Cost cost) {
+        costs[shape(op)][static_cast<int>(backend)] = cost;
+    }
+
+    void set_width(unsigned int threads) { width = std::max(1u, threads); }
+
+    const Cost& cost(OlapOp op, Backend backend) const {
+        return costs[shape(op)][static_cast<int>(backend)];
+    }
+
+    unsigned int max_threads() const { return width; }
+    double calibration_time() const { return calibration_seconds; }
+
+    // Cheapest backend for op over cells input cells; ties go to the
+    // simpler backend
+    BackendChoice choose(OlapOp op, size_t cells) const
+    {
+        BackendChoice choice;
+        const double seq_per_cell = cost(op, Backend::Sequential).per_cell;
+
+        for (Backend b : {Backend::Sequential, Backend::Threads, Backend::OpenMP})
+        {
+            const Cost& c = cost(op, b);
+            BackendEstimate e{b, 1, c.predict(cells)};
+
+            if (b != Backend::Sequential) {
+                e.threads = width;
+                if (seq_per_cell > 0.0 && c.overhead > 0.0) {
+                    const double grain = c.overhead / seq_per_cell;
+                    const double wanted = std::ceil(static_cast<double>(cells) / grain);
+                    e.threads = static_cast<unsigned int>(
+                        std::max(1.0, std::min<double>(width, wanted)));
+                    e.seconds = c.overhead + c.per_cell * static_cast<double>(cells) *
+                                width / e.threads;
+                }
+            }
+
+            choice.candidates[static_cast<int>(b)] = e;
+            if (b == Backend::Sequential || e.seconds < choice.best.seconds)
+                choice.best = e;
+        }
+
+        return choice;
+    }
+};
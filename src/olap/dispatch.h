@@ -0,0 +1,268 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/cube_view.h"
+#include "../cube/tiled_cube.h"
+#include "../cube/pixel_major_cube.h"
+#include "../cube/validity_mask.h"
+#include "../cube/prefix_sum_index.h"
+#include "omp_operations.h"
+#include "tiled_operations.h"
+#include "pixel_operations.h"
+#include "simple_operations.h"
+#include "cost_model.h"
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// Routes OLAP queries on one cube to the layouts currently resident.
+// The t-major cube (owned or a view, e.g. of a mapped file) is always
+// there; tiled and pixel-major copies are optional secondary layouts
+// built on request. Time-axis reductions and drill-downs go to the
+// pixel-major copy when resident, then the tiled one; spatial queries
+// (slices, dice, spatial means) stay on the t-major cube.
+// With a validity mask attached, spatial means average observed cells only.
+// A resident prefix-sum index answers region means in O(1) per box.
+// Whatever is left on the t-major cube goes to the backend (simple_olap,
+// parallel_olap or omp_olap) and thread count the cost model predicts to
+// be fastest for the number of cells read; explain() shows the decision.
+template<typename Dtype>
+class CubeDispatcher {
+public:
+    enum class Layout { RowMajor, Tiled, PixelMajor };
+
+    // How one query will be answered
+    struct QueryPlan {
+        OlapOp op;
+        size_t cells = 0;            // input cells read
+        const char* route = "";      // layout or structure answering it
+        bool cost_based = false;     // route runs the backend in choice
+        BackendChoice choice;
+    };
+
+    static const char* layout_name(Layout layout) {
+        switch (layout) {
+            case Layout::RowMajor:   return "row-major";
+            case Layout::Tiled:      return "tiled";
+            case Layout::PixelMajor: return "pixel-major";
+        }
+        return "unknown";
+    }
+
+private:
+    CubeView<Dtype> cube;
+    std::unique_ptr<TiledCube<Dtype>> tiled;
+    std::unique_ptr<PixelMajorCube<Dtype>> pixel_major;
+    const ValidityMask* valid = nullptr;
+    std::unique_ptr<PrefixSumIndex> prefix;
+    CostModel model;
+
+public:
+    // Uses the process-wide cost model, calibrating it on first use
+    explicit CubeDispatcher(CubeView<Dtype> base)
+        : cube(base), model(CostModel::instance()) {}
+
+    CubeDispatcher(CubeView<Dtype> base, const CostModel& costs)
+        : cube(base), model(costs) {}
+
+    CubeView<Dtype> row_major() const { return cube; }
+
+    // ---- Resident layouts ----
+
+    void build_tiled(TileShape shape = TileShape()) {
+        tiled = std::make_unique<TiledCube<Dtype>>(
+            TiledCube<Dtype>::from_cube(cube, shape));
+    }
+
+    void build_pixel_major(size_t block = 64) {
+        pixel_major = std::make_unique<PixelMajorCube<Dtype>>(
+            PixelMajorCube<Dtype>::from_cube(cube, block));
+    }
+
+    // Summed-area table over the cube (and the attached mask, if any)
+    void build_prefix_index() {
+        prefix = std::make_unique<PrefixSumIndex>(
+            PrefixSumIndex::build(cube, valid));
+    }
+
+    void drop_secondary() {
+        tiled.reset();
+        pixel_major.reset();
+        prefix.reset();
+    }
+
+    bool has_tiled() const { return tiled != nullptr; }
+    bool has_pixel_major() const { return pixel_major != nullptr; }
+    bool has_prefix_index() const { return prefix != nullptr; }
+
+    // Layout that time-axis reductions will read
+    Layout time_layout() const {
+        if (pixel_major) return Layout::PixelMajor;
+        if (tiled) return Layout::Tiled;
+        return Layout::RowMajor;
+    }
+
+    // Layout that timeseries drill-downs will read
+    Layout series_layout() const {
+        return pixel_major ? Layout::PixelMajor : Layout::RowMajor;
+    }
+
+    // Bytes held by the secondary copies
+    size_t secondary_bytes() const {
+        size_t bytes = 0;
+        if (tiled) bytes += tiled->storage_size() * sizeof(Dtype);
+        if (pixel_major) bytes += pixel_major->size() * sizeof(Dtype);
+        if (prefix) bytes += prefix->bytes();
+        return bytes;
+    }
+
+    // ---- Validity ----
+
+    // Not owned; must outlive the dispatcher. nullptr detaches.
+    // A resident prefix index is dropped, since its counts follow the mask.
+    void set_validity(const ValidityMask* mask) {
+        if (mask && !mask->matches(cube))
+            throw std::invalid_argument("Validity mask does not match cube dimensions");
+        valid = mask;
+        prefix.reset();
+    }
+
+    const ValidityMask* validity() const { return valid; }
+    bool has_validity() const { return valid != nullptr; }
+
+    // ---- Backend selection ----
+
+    void set_cost_model(const CostModel& costs) { model = costs; }
+    const CostModel& cost_model() const { return model; }
+
+    // Route for op over box (the whole cube for global means and rollups)
+    QueryPlan explain(OlapOp op, const CubeBox& box) const {
+        QueryPlan plan;
+        plan.op = op;
+        plan.cells = box.volume();
+        plan.route = "row-major";
+
+        switch (op) {
+            case OlapOp::RollupTimeSum:
+            case OlapOp::RollupTimeMean:
+                if (time_layout() != Layout::RowMajor) {
+                    plan.route = layout_name(time_layout());
+                    return plan;
+                }
+                break;
+            case OlapOp::RegionMean:
+                if (prefix) {
+                    plan.route = "prefix index";
+                    plan.cells = 8;
+                    return plan;
+                }
+                [[fallthrough]];
+            case OlapOp::GlobalMean:
+                if (valid) {
+                    plan.route = "validity mask (omp_olap)";
+                    return plan;
+                }
+                break;
+        }
+
+        plan.cost_based = true;
+        plan.choice = model.choose(op, plan.cells);
+        return plan;
+    }
+
+    QueryPlan explain(OlapOp op) const {
+        return explain(op, {0, cube.time_dim(), 0, cube.lat_dim(), 0, cube.lon_dim()});
+    }
+
+    // ---- Time-axis reductions ----
+
+    SimpleCube<Dtype> rollup_time_sum() const {
+        switch (time_layout()) {
+            case Layout::PixelMajor: return pixel_olap::rollup_time_sum(*pixel_major);
+            case Layout::Tiled:      return tiled_olap::rollup_time_sum(*tiled);
+            default:
+                return backend_olap::rollup_time_sum(
+                    cube, explain(OlapOp::RollupTimeSum).choice.best);
+        }
+    }
+
+    SimpleCube<Dtype> rollup_time_mean() const {
+        switch (time_layout()) {
+            case Layout::PixelMajor: return pixel_olap::rollup_time_mean(*pixel_major);
+            case Layout::Tiled:      return tiled_olap::rollup_time_mean(*tiled);
+            default:
+                return backend_olap::rollup_time_mean(
+                    cube, explain(OlapOp::RollupTimeMean).choice.best);
+        }
+    }
+
+    std::vector<Dtype> timeseries(size_t lat, size_t lon) const {
+        if (pixel_major)
+            return pixel_olap::timeseries(*pixel_major, lat, lon);
+        return simple_olap::timeseries(cube, lat, lon);
+    }
+
+    std::vector<Dtype> region_timeseries(size_t lat_start, size_t lat_end,
+                                         size_t lon_start, size_t lon_end) const {
+        if (pixel_major)
+            return pixel_olap::region_timeseries(*pixel_major,
+                                                 lat_start, lat_end, lon_start, lon_end);
+        return simple_olap::region_timeseries(cube,
+                                              lat_start, lat_end, lon_start, lon_end);
+    }
+
+    // ---- Spatial queries ----
+
+    CubeView<Dtype> slice_time(size_t t) const {
+        return omp_olap::slice_time(cube, t);
+    }
+
+    CubeView<Dtype> dice(size_t t_start, size_t t_end,
+                         size_t lat_start, size_t lat_end,
+                         size_t lon_start, size_t lon_end) const {
+        return omp_olap::dice(cube, t_start, t_end, lat_start, lat_end, lon_start, lon_end);
+    }
+
+    Dtype global_mean() const {
+        if (valid)
+            return omp_olap::global_mean(cube, *valid);
+        return backend_olap::global_mean(cube, explain(OlapOp::GlobalMean).choice.best);
+    }
+
+    Dtype region_mean(size_t t_start, size_t t_end,
+                      size_t lat_start, size_t lat_end,
+                      size_t lon_start, size_t lon_end) const {
+        if (prefix)
+            return static_cast<Dtype>(prefix->box_mean(
+                {t_start, t_end, lat_start, lat_end, lon_start, lon_end}));
+        if (valid)
+            return omp_olap::region_mean(cube, *valid, t_start, t_end,
+                                         lat_start, lat_end, lon_start, lon_end);
+
+        const CubeBox box{t_start, t_end, lat_start, lat_end, lon_start, lon_end};
+        return backend_olap::region_mean(cube, box, explain(OlapOp::RegionMean, box).choice.best);
+    }
+
+    // Many boxes at once: one O(1) lookup per box when the prefix index
+    // is resident, otherwise one scan per box
+    std::vector<Dtype> region_means(const std::vector<CubeBox>& boxes) const {
+        std::vector<Dtype> means(boxes.size());
+
+        if (prefix) {
+            for (const CubeBox& b : boxes)
+                prefix->check(b);
+
+            #pragma omp parallel for schedule(static)
+            for (size_t i = 0; i < boxes.size(); ++i)
+                means[i] = static_cast<Dtype>(prefix->box_mean(boxes[i]));
+            return means;
+        }
+
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            const CubeBox& b = boxes[i];
+            means[i] = region_mean(b.t_start, b.t_end, b.lat_start, b.lat_end,
+                                   b.lon_start, b.lon_end);
+        }
+        return means;
+    }
+};
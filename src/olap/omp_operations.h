@@ -1,77 +1,51 @@
 #pragma once
 #include "../cube/simple_cube.h"
+#include "../cube/cube_view.h"
+#include "../cube/validity_mask.h"
+#include "time_reduction.h"
 #include <omp.h>
 #include <cstddef>
+#include <stdexcept>
+#include <vector>
 
+// Slice and dice return non-owning CubeViews (O(1), no copy); aggregates
+// accept either a SimpleCube or a view and parallelize over its rows.
 namespace omp_olap {
 
 //////////////////////////////////////////////////////////////
 // SLICE
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-SimpleCube<Dtype> slice_time(const SimpleCube<Dtype>& cube, size_t t)
+template<typename Cube, typename Dtype = typename Cube::value_type>
+CubeView<Dtype> slice_time(const Cube& cube, size_t t)
 {
-    size_t LAT = cube.lat_dim();
-    size_t LON = cube.lon_dim();
-
-    SimpleCube<Dtype> result(1, LAT, LON);
-
-#pragma omp parallel for schedule(static)
-    for (size_t lat = 0; lat < LAT; ++lat)
-    {
-    #pragma omp simd
-        for (size_t lon = 0; lon < LON; ++lon)
-        {
-            result.at(0, lat, lon) = cube.at(t, lat, lon);
-        }
-    }
-
-    return result;
+    return CubeView<Dtype>(cube).sub(t, t + 1,
+                                     0, cube.lat_dim(),
+                                     0, cube.lon_dim());
 }
 
 //////////////////////////////////////////////////////////////
 // DICE
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-SimpleCube<Dtype> dice(const SimpleCube<Dtype>& cube,
-                       size_t t_start, size_t t_end,
-                       size_t lat_start, size_t lat_end,
-                       size_t lon_start, size_t lon_end)
+template<typename Cube, typename Dtype = typename Cube::value_type>
+CubeView<Dtype> dice(const Cube& cube,
+                     size_t t_start, size_t t_end,
+                     size_t lat_start, size_t lat_end,
+                     size_t lon_start, size_t lon_end)
 {
-    size_t newT   = t_end - t_start;
-    size_t newLAT = lat_end - lat_start;
-    size_t newLON = lon_end - lon_start;
-
-    SimpleCube<Dtype> result(newT, newLAT, newLON);
-
-#pragma omp parallel for schedule(static)
-    for (size_t t = 0; t < newT; ++t)
-    {
-        for (size_t lat = 0; lat < newLAT; ++lat)
-        {
-        #pragma omp simd
-            for (size_t lon = 0; lon < newLON; ++lon)
-            {
-                result.at(t, lat, lon) =
-                    cube.at(t + t_start,
-                            lat + lat_start,
-                            lon + lon_start);
-            }
-        }
-    }
-
-    return result;
+    return CubeView<Dtype>(cube).sub(t_start, t_end,
+                                     lat_start, lat_end,
+                                     lon_start, lon_end);
 }
 
 //////////////////////////////////////////////////////////////
 // DICE TIME
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-SimpleCube<Dtype> dice_time(const SimpleCube<Dtype>& cube,
-                            size_t t_start, size_t t_end)
+template<typename Cube, typename Dtype = typename Cube::value_type>
+CubeView<Dtype> dice_time(const Cube& cube,
+                          size_t t_start, size_t t_end)
 {
     return dice(cube,
                 t_start, t_end,
@@ -83,10 +57,10 @@ SimpleCube<Dtype> dice_time(const SimpleCube<Dtype>& cube,
 // DICE REGION
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-SimpleCube<Dtype> dice_region(const SimpleCube<Dtype>& cube,
-                              size_t lat_start, size_t lat_end,
-                              size_t lon_start, size_t lon_end)
+template<typename Cube, typename Dtype = typename Cube::value_type>
+CubeView<Dtype> dice_region(const Cube& cube,
+                            size_t lat_start, size_t lat_end,
+                            size_t lon_start, size_t lon_end)
 {
     return dice(cube,
                 0, cube.time_dim(),
@@ -126,44 +100,30 @@ SimpleCube<Dtype> dice_region(const SimpleCube<Dtype>& cube,
 //     return result;
 // }
 
-template<typename Dtype>
-SimpleCube<Dtype> rollup_time_mean(const SimpleCube<Dtype>& cube)
+// Time rollups and the global mean run on the time_reduction engine:
+// each thread takes whole lat bands and sums them over every hour, with
+// no barrier between hours.
+
+template<typename Cube, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_time_mean(const Cube& cube)
 {
     size_t T   = cube.time_dim();
     size_t LAT = cube.lat_dim();
     size_t LON = cube.lon_dim();
 
     SimpleCube<Dtype> result(1, LAT, LON);
+    auto bands = time_reduction::plan<Dtype>(LAT, LON, time_reduction::omp_workers());
 
-#pragma omp parallel
-{
-    // initialize
-#pragma omp for collapse(2) schedule(static)
-    for (size_t lat = 0; lat < LAT; ++lat)
-        for (size_t lon = 0; lon < LON; ++lon)
-            result.at(0, lat, lon) = 0;
-
-    // accumulate
-    for (size_t t = 0; t < T; ++t)
+    // each band is normalized while it is still in cache
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < bands.count; ++b)
     {
-#pragma omp for schedule(static)
-        for (size_t lat = 0; lat < LAT; ++lat)
-        {
-#pragma omp simd
-            for (size_t lon = 0; lon < LON; ++lon)
-            {
-                result.at(0, lat, lon) += cube.at(t, lat, lon);
-            }
-        }
+        Dtype* acc = result.row(0, bands.begin(b));
+        time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc);
+        time_reduction::divide(acc, (bands.end(b) - bands.begin(b)) * LON,
+                               static_cast<Dtype>(T));
     }
 
-    // normalize
-#pragma omp for collapse(2) schedule(static)
-    for (size_t lat = 0; lat < LAT; ++lat)
-        for (size_t lon = 0; lon < LON; ++lon)
-            result.at(0, lat, lon) /= static_cast<Dtype>(T);
-}
-
     return result;
 }
 
@@ -173,30 +133,19 @@ SimpleCube<Dtype> rollup_time_mean(const SimpleCube<Dtype>& cube)
 // ROLLUP TIME SUM
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-SimpleCube<Dtype> rollup_time_sum(const SimpleCube<Dtype>& cube)
+template<typename Cube, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_time_sum(const Cube& cube)
 {
-    size_t T   = cube.time_dim();
     size_t LAT = cube.lat_dim();
     size_t LON = cube.lon_dim();
 
     SimpleCube<Dtype> result(1, LAT, LON);
+    auto bands = time_reduction::plan<Dtype>(LAT, LON, time_reduction::omp_workers());
 
-#pragma omp parallel for collapse(2) schedule(static)
-    for (size_t lat = 0; lat < LAT; ++lat)
-    {
-        for (size_t lon = 0; lon < LON; ++lon)
-        {
-            Dtype sum = 0;
-
-            for (size_t t = 0; t < T; ++t)
-            {
-                sum += cube.at(t, lat, lon);
-            }
-
-            result.at(0, lat, lon) = sum;
-        }
-    }
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < bands.count; ++b)
+        time_reduction::sum_band(cube, bands.begin(b), bands.end(b),
+                                 result.row(0, bands.begin(b)));
 
     return result;
 }
@@ -205,25 +154,28 @@ SimpleCube<Dtype> rollup_time_sum(const SimpleCube<Dtype>& cube)
 // GLOBAL MEAN
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-Dtype global_mean(const SimpleCube<Dtype>& cube)
+// Band sums over time, then over the band: each cell's hours are added
+// first, so the running totals stay small
+template<typename Cube, typename Dtype = typename Cube::value_type>
+Dtype global_mean(const Cube& cube)
 {
     size_t T   = cube.time_dim();
     size_t LAT = cube.lat_dim();
     size_t LON = cube.lon_dim();
 
+    auto bands = time_reduction::plan<Dtype>(LAT, LON, time_reduction::omp_workers());
+
     Dtype sum = 0;
 
-#pragma omp parallel for reduction(+:sum) schedule(static)
-    for (size_t t = 0; t < T; ++t)
+#pragma omp parallel reduction(+:sum)
     {
-        for (size_t lat = 0; lat < LAT; ++lat)
+        std::vector<Dtype, AlignedAllocator<Dtype>> acc(bands.rows * LON);
+
+#pragma omp for schedule(static)
+        for (size_t b = 0; b < bands.count; ++b)
         {
-            #pragma omp simd reduction(+:sum)
-            for (size_t lon = 0; lon < LON; ++lon)
-            {
-                sum += cube.at(t, lat, lon);
-            }
+            time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc.data());
+            sum += time_reduction::total(acc.data(), (bands.end(b) - bands.begin(b)) * LON);
         }
     }
 
@@ -235,22 +187,28 @@ Dtype global_mean(const SimpleCube<Dtype>& cube)
 // REGION MEAN
 //////////////////////////////////////////////////////////////
 
-template<typename Dtype>
-Dtype region_mean(const SimpleCube<Dtype>& cube,
+template<typename Cube, typename Dtype = typename Cube::value_type>
+Dtype region_mean(const Cube& cube,
                   size_t t_start, size_t t_end,
                   size_t lat_start, size_t lat_end,
                   size_t lon_start, size_t lon_end)
 {
+    if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+        return 0;
+
     Dtype sum = 0;
 
-#pragma omp parallel for collapse(3) reduction(+:sum) schedule(static)
+#pragma omp parallel for collapse(2) reduction(+:sum) schedule(static)
     for (size_t t = t_start; t < t_end; ++t)
     {
         for (size_t lat = lat_start; lat < lat_end; ++lat)
         {
+            const Dtype* src = cube.row(t, lat);
+
+            #pragma omp simd reduction(+:sum)
             for (size_t lon = lon_start; lon < lon_end; ++lon)
             {
-                sum += cube.at(t, lat, lon);
+                sum += src[lon];
             }
         }
     }
@@ -263,4 +221,133 @@ Dtype region_mean(const SimpleCube<Dtype>& cube,
     return sum / static_cast<Dtype>(count);
 }
 
+//////////////////////////////////////////////////////////////
+// OBSERVED MEANS (validity mask)
+//////////////////////////////////////////////////////////////
+
+// Mean over observed cells only: empty cells are left out of both the sum
+// and the count instead of averaging in as zero. Each row is walked a
+// mask word at a time; zero words skip 64 cells without touching the
+// values, full words take a contiguous simd sum, and mixed words visit
+// set bits only. Returns 0 when nothing in range was observed.
+template<typename Cube, typename Dtype = typename Cube::value_type>
+Dtype region_mean(const Cube& cube,
+                  const ValidityMask& valid,
+                  size_t t_start, size_t t_end,
+                  size_t lat_start, size_t lat_end,
+                  size_t lon_start, size_t lon_end)
+{
+    if (!valid.matches(cube))
+        throw std::invalid_argument("Validity mask does not match cube dimensions");
+
+    if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+        return 0;
+
+    const size_t w_first = lon_start / 64;
+    const size_t w_last  = (lon_end - 1) / 64;
+    const uint64_t first_mask = ~uint64_t(0) << (lon_start % 64);
+    const uint64_t last_mask  = ~uint64_t(0) >> (63 - (lon_end - 1) % 64);
+
+    Dtype sum = 0;
+    size_t observed = 0;
+
+#pragma omp parallel for collapse(2) reduction(+:sum,observed) schedule(static)
+    for (size_t t = t_start; t < t_end; ++t)
+    {
+        for (size_t lat = lat_start; lat < lat_end; ++lat)
+        {
+            const Dtype* src = cube.row(t, lat);
+            const uint64_t* bits = valid.row(t, lat);
+
+            for (size_t w = w_first; w <= w_last; ++w)
+            {
+                uint64_t word = bits[w];
+                if (w == w_first) word &= first_mask;
+                if (w == w_last)  word &= last_mask;
+
+                if (word == 0)
+                    continue;
+
+                const Dtype* block = src + w * 64;
+
+                if (word == ~uint64_t(0))
+                {
+                    #pragma omp simd reduction(+:sum)
+                    for (size_t i = 0; i < 64; ++i)
+                        sum += block[i];
+
+                    observed += 64;
+                    continue;
+                }
+
+                observed += popcount64(word);
+                for (; word; word &= word - 1)
+                    sum += block[ctz64(word)];
+            }
+        }
+    }
+
+    return observed ? sum / static_cast<Dtype>(observed) : Dtype(0);
+}
+
+// Hours observed per pixel
+inline SimpleCube<int32_t> rollup_time_count(const ValidityMask& valid)
+{
+    const size_t LAT = valid.lat_dim();
+    const size_t LON = valid.lon_dim();
+
+    SimpleCube<int32_t> result(1, LAT, LON);
+    auto bands = time_reduction::plan<int32_t>(LAT, LON, time_reduction::omp_workers());
+
+#pragma omp parallel for schedule(static)
+    for (size_t b = 0; b < bands.count; ++b)
+        time_reduction::count_band(valid, bands.begin(b), bands.end(b),
+                                   result.row(0, bands.begin(b)));
+
+    return result;
+}
+
+// Per-pixel mean over observed hours; 0 where nothing was observed
+template<typename Cube, typename Dtype = typename Cube::value_type>
+SimpleCube<Dtype> rollup_time_mean(const Cube& cube, const ValidityMask& valid)
+{
+    if (!valid.matches(cube))
+        throw std::invalid_argument("Validity mask does not match cube dimensions");
+
+    const size_t LAT = cube.lat_dim();
+    const size_t LON = cube.lon_dim();
+
+    SimpleCube<Dtype> result(1, LAT, LON);
+    auto bands = time_reduction::plan<Dtype>(LAT, LON, time_reduction::omp_workers());
+
+#pragma omp parallel
+    {
+        std::vector<int32_t, AlignedAllocator<int32_t>> count(bands.rows * LON);
+
+#pragma omp for schedule(static)
+        for (size_t b = 0; b < bands.count; ++b)
+        {
+            Dtype* acc = result.row(0, bands.begin(b));
+            const size_t n = (bands.end(b) - bands.begin(b)) * LON;
+
+            time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc);
+            time_reduction::count_band(valid, bands.begin(b), bands.end(b), count.data());
+
+            for (size_t i = 0; i < n; ++i)
+                acc[i] = count[i] ? acc[i] / static_cast<Dtype>(count[i]) : Dtype(0);
+        }
+    }
+
+    return result;
+}
+
+template<typename Cube, typename Dtype = typename Cube::value_type>
+Dtype global_mean(const Cube& cube, const ValidityMask& valid)
+{
+    return region_mean(cube, valid,
+                       0, cube.time_dim(),
+                       0, cube.lat_dim(),
+                       0, cube.lon_dim());
+}
+
 } // namespace omp_olap
@@ -1,113 +1,84 @@
 #pragma once
 #include "../cube/datacube.h"
+#include "../cube/cube_view.h"
+#include "time_reduction.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <vector>
 
+// Datacube kernels. Slice and dice return non-owning CubeViews;
+// aggregates accept a Datacube or a view.
 namespace olap {
-    template<typename Dtype>
-    std::vector<Dtype> slice_time(const Datacube<Dtype>&cube, size_t t){
-        size_t LAT = cube.lat_dim();
-        size_t LON = cube.lon_dim();
-
-        std::vector<Dtype> result(LAT*LON);
-
-        for(size_t lat =0;lat<LAT;lat++){
-            for(size_t lon = 0;lon<LON;lon++){
-                result[lat*LON + lon] = cube.at(t, lat, lon);
-            }
-        }
-
-        return result;
+    // Slice: view of one time step, no copy
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> slice_time(const Cube& cube, size_t t){
+        return CubeView<Dtype>(cube).sub(t, t+1,
+                                         0, cube.lat_dim(),
+                                         0, cube.lon_dim());
     }
 
-    template<typename Dtype>
-    Datacube<Dtype> dice(const Datacube<Dtype>& cube,
+    // Dice: view of a sub-cube; materialize<Datacube<Dtype>>() to copy
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice(const Cube& cube,
         size_t t_start,size_t t_end,
         size_t lat_start,size_t lat_end,
     size_t lon_start,size_t lon_end)
     {
-        size_t newT = t_end-t_start;
-        size_t newLAT = lat_end - lat_start;
-        size_t newLON = lon_end - lon_start;
-
-        Datacube<Dtype> result(newT,newLAT,newLON);
-
-        for(size_t t=0;t<newT;++t)
-            for(size_t lat=0;lat<newLAT;++lat)
-                for(size_t lon=0;lon<newLON;++lon)
-                    result.at(t,lat,lon)=cube.at(t+t_start,lat+lat_start,lon+lon_start);
-
-        return result;
+        return CubeView<Dtype>(cube).sub(t_start,t_end,
+                                         lat_start,lat_end,
+                                         lon_start,lon_end);
     }
 
-    template<typename Dtype>
-    Datacube<Dtype> rollup_time_mean(const Datacube<Dtype>& cube){
-        size_t T_dim = cube.time_dim();
+    // Time rollups and the global mean walk the time_reduction bands in order
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Datacube<Dtype> rollup_time_sum(const Cube& cube)
+    {
         size_t LAT = cube.lat_dim();
         size_t LON = cube.lon_dim();
 
         Datacube<Dtype> result(1, LAT, LON);
+        auto bands = time_reduction::plan<Dtype>(LAT, LON);
 
-        for(size_t lat=0;lat<LAT;++lat){
-            for(size_t lon=0;lon<LON;++lon){
-                Dtype sum =0;
+        for (size_t b = 0; b < bands.count; ++b)
+            time_reduction::sum_band(cube, bands.begin(b), bands.end(b),
+                                     result.row(0, bands.begin(b)));
 
-                for(size_t t=0;t<T_dim;++t){
-                    sum+= cube.at(t,lat,lon); // no cache locality on time
-                }
-
-                result.at(0,lat,lon)=sum/static_cast<double>(T_dim);
-            }
-        }
         return result;
     }
 
-    template<typename Dtype>
-    Datacube<Dtype> rollup_time_sum(const Datacube<Dtype>& cube)
-    {
-        size_t T_dim = cube.time_dim();
-        size_t LAT = cube.lat_dim();
-        size_t LON = cube.lon_dim();
-
-        Datacube<Dtype> result(1, LAT, LON);
-
-        for (size_t lat = 0; lat < LAT; ++lat) {
-            for (size_t lon = 0; lon < LON; ++lon) {
-
-                Dtype sum = 0;
-
-                for (size_t t = 0; t < T_dim; ++t)
-                    sum += cube.at(t, lat, lon);
-
-                result.at(0, lat, lon) = sum;
-            }
-        }
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Datacube<Dtype> rollup_time_mean(const Cube& cube){
+        Datacube<Dtype> result = rollup_time_sum(cube);
 
+        time_reduction::divide(result.data(), result.size(),
+                               static_cast<double>(cube.time_dim()));
         return result;
     }
 
-    template<typename Dtype>
-    Dtype global_mean(const Datacube<Dtype>& cube)
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype global_mean(const Cube& cube)
     {
         size_t T_dim = cube.time_dim();
         size_t LAT = cube.lat_dim();
         size_t LON = cube.lon_dim();
 
-        Dtype sum = 0;
+        auto bands = time_reduction::plan<Dtype>(LAT, LON);
+        std::vector<Dtype, AlignedAllocator<Dtype>> acc(bands.rows * LON);
 
-        for (size_t t = 0; t < T_dim; ++t)
-            for (size_t lat = 0; lat < LAT; ++lat)
-                for (size_t lon = 0; lon < LON; ++lon)
-                    sum += cube.at(t, lat, lon);
+        Dtype sum = 0;
+        for (size_t b = 0; b < bands.count; ++b) {
+            time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc.data());
+            sum += time_reduction::total(acc.data(), (bands.end(b) - bands.begin(b)) * LON);
+        }
 
         return sum / static_cast<double>(T_dim * LAT * LON);
     }
 
 
-    template<typename Dtype>
+    template<typename Cube, typename Dtype = typename Cube::value_type>
     Dtype region_mean(
-        const Datacube<Dtype>& cube,
+        const Cube& cube,
         size_t t_start,
         size_t t_end,
         size_t lat_start,
@@ -115,27 +86,29 @@ namespace olap {
         size_t lon_start,
         size_t lon_end)
     {
-        Dtype sum = 0;
-        size_t count = 0;
+        if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+            return 0;
 
-        // checks for input variables
+        Dtype sum = 0;
 
         for (size_t t = t_start; t < t_end; ++t)
             for (size_t lat = lat_start; lat < lat_end; ++lat)
+            {
+                const Dtype* src = cube.row(t, lat);
+
+                #pragma omp simd reduction(+:sum)
                 for (size_t lon = lon_start; lon < lon_end; ++lon)
-                {
-                    sum += cube.at(t, lat, lon);
-                    ++count;
-                }
+                    sum += src[lon];
+            }
 
-        if (count == 0) return 0;
+        size_t count = (t_end - t_start) * (lat_end - lat_start) * (lon_end - lon_start);
 
         return sum / static_cast<Dtype>(count);
     }
 
-    template<typename Dtype>
-    Datacube<Dtype> dice_time(
-        const Datacube<Dtype>& cube,
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice_time(
+        const Cube& cube,
         size_t t_start,
         size_t t_end)
     {
@@ -145,9 +118,9 @@ namespace olap {
                     0, cube.lon_dim());
     }
 
-    template<typename Dtype>
-    Datacube<Dtype> dice_region(
-        const Datacube<Dtype>& cube,
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice_region(
+        const Cube& cube,
         size_t lat_start,
         size_t lat_end,
         size_t lon_start,
@@ -1,123 +1,64 @@
 #pragma once
 #include "../cube/simple_cube.h"
+#include "../cube/cube_view.h"
+#include "../utils/thread_pool.h"
+#include "time_reduction.h"
+#include <algorithm>
 #include <cstddef>
 #include <vector>
-#include <thread>
 
+// ThreadPool kernels; each task walks contiguous row(t, lat) spans.
+// Slice and dice return non-owning CubeViews; aggregates accept a
+// SimpleCube or a view.
 namespace parallel_olap {
 
-    // Slice: parallel version - each thread handles a portion of lat rows
-    template<typename Dtype>
-    SimpleCube<Dtype> slice_time(const SimpleCube<Dtype>& cube, size_t t, unsigned int num_threads = 0) {
-        if (num_threads == 0) {
-            num_threads = std::thread::hardware_concurrency();
-            if (num_threads == 0) num_threads = 4;
-        }
-
-        size_t LAT = cube.lat_dim();
-        size_t LON = cube.lon_dim();
-
-        SimpleCube<Dtype> result(1, LAT, LON);
-
-        size_t lat_per_thread = (LAT + num_threads - 1) / num_threads;
-
-        auto worker = [&](size_t lat_start, size_t lat_end) {
-            for (size_t lat = lat_start; lat < lat_end; ++lat) {
-                for (size_t lon = 0; lon < LON; ++lon) {
-                    result.at(0, lat, lon) = cube.at(t, lat, lon);
-                }
-            }
-        };
-
-        std::vector<std::thread> threads;
-        for (unsigned int i = 0; i < num_threads; ++i) {
-            size_t start = i * lat_per_thread;
-            size_t end = std::min(start + lat_per_thread, LAT);
-            if (start >= LAT) break;
-            threads.emplace_back(worker, start, end);
-        }
-
-        for (auto& th : threads) {
-            th.join();
-        }
-
-        return result;
+    // Slice: view of one time step; O(1), so there is nothing to parallelize
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> slice_time(const Cube& cube, size_t t) {
+        return CubeView<Dtype>(cube).sub(t, t + 1,
+                                         0, cube.lat_dim(),
+                                         0, cube.lon_dim());
     }
 
-    // Dice: parallel version - each thread handles a portion of time slices
-    template<typename Dtype>
-    SimpleCube<Dtype> dice(const SimpleCube<Dtype>& cube,
-                           size_t t_start, size_t t_end,
-                           size_t lat_start, size_t lat_end,
-                           size_t lon_start, size_t lon_end,
-                           unsigned int num_threads = 0) {
-        if (num_threads == 0) {
-            num_threads = std::thread::hardware_concurrency();
-            if (num_threads == 0) num_threads = 4;
-        }
-
-        size_t newT = t_end - t_start;
-        size_t newLAT = lat_end - lat_start;
-        size_t newLON = lon_end - lon_start;
-
-        SimpleCube<Dtype> result(newT, newLAT, newLON);
-
-        size_t time_per_thread = (newT + num_threads - 1) / num_threads;
-
-        auto worker = [&](size_t time_offset_start, size_t time_offset_end) {
-            for (size_t t = time_offset_start; t < time_offset_end; ++t) {
-                for (size_t lat = 0; lat < newLAT; ++lat) {
-                    for (size_t lon = 0; lon < newLON; ++lon) {
-                        result.at(t, lat, lon) = cube.at(t + t_start, lat + lat_start, lon + lon_start);
-                    }
-                }
-            }
-        };
-
-        std::vector<std::thread> threads;
-        for (unsigned int i = 0; i < num_threads; ++i) {
-            size_t start = i * time_per_thread;
-            size_t end = std::min(start + time_per_thread, newT);
-            if (start >= newT) break;
-            threads.emplace_back(worker, start, end);
-        }
-
-        for (auto& th : threads) {
-            th.join();
-        }
-
-        return result;
+    // Dice: view of a sub-cube; materialize() it for an owning copy
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice(const Cube& cube,
+                         size_t t_start, size_t t_end,
+                         size_t lat_start, size_t lat_end,
+                         size_t lon_start, size_t lon_end) {
+        return CubeView<Dtype>(cube).sub(t_start, t_end,
+                                         lat_start, lat_end,
+                                         lon_start, lon_end);
     }
 
     // Dice by time range only
-    template<typename Dtype>
-    SimpleCube<Dtype> dice_time(const SimpleCube<Dtype>& cube,
-                                size_t t_start, size_t t_end,
-                                unsigned int num_threads = 0) {
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice_time(const Cube& cube,
+                              size_t t_start, size_t t_end) {
         return dice(cube, t_start, t_end,
                     0, cube.lat_dim(),
-                    0, cube.lon_dim(),
-                    num_threads);
+                    0, cube.lon_dim());
     }
 
     // Dice by region only
-    template<typename Dtype>
-    SimpleCube<Dtype> dice_region(const SimpleCube<Dtype>& cube,
-                                  size_t lat_start, size_t lat_end,
-                                  size_t lon_start, size_t lon_end,
-                                  unsigned int num_threads = 0) {
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice_region(const Cube& cube,
+                                size_t lat_start, size_t lat_end,
+                                size_t lon_start, size_t lon_end) {
         return dice(cube, 0, cube.time_dim(),
                     lat_start, lat_end,
-                    lon_start, lon_end,
-                    num_threads);
+                    lon_start, lon_end);
     }
 
-    // Rollup: time mean - parallel over lat dimension
-    template<typename Dtype>
-    SimpleCube<Dtype> rollup_time_mean(const SimpleCube<Dtype>& cube, unsigned int num_threads = 0) {
+    // Time rollups and the global mean run on the time_reduction engine;
+    // num_threads is the number of parts the bands are split into, 0 = pool size
+
+    // Rollup: time mean - parallel over lat bands
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    SimpleCube<Dtype> rollup_time_mean(const Cube& cube, unsigned int num_threads = 0) {
+        ThreadPool& pool = ThreadPool::instance();
         if (num_threads == 0) {
-            num_threads = std::thread::hardware_concurrency();
-            if (num_threads == 0) num_threads = 4;
+            num_threads = pool.size();
         }
 
         size_t T_dim = cube.time_dim();
@@ -125,125 +66,123 @@ namespace parallel_olap {
         size_t LON = cube.lon_dim();
 
         SimpleCube<Dtype> result(1, LAT, LON);
-
-        size_t lat_per_thread = (LAT + num_threads - 1) / num_threads;
-
-        auto worker = [&](size_t lat_start, size_t lat_end) {
-            for (size_t lat = lat_start; lat < lat_end; ++lat) {
-                for (size_t lon = 0; lon < LON; ++lon) {
-                    Dtype sum = 0;
-                    for (size_t t = 0; t < T_dim; ++t) {
-                        sum += cube.at(t, lat, lon);
-                    }
-                    result.at(0, lat, lon) = sum / static_cast<Dtype>(T_dim);
-                }
+        auto bands = time_reduction::plan<Dtype>(LAT, LON, num_threads);
+
+        auto worker = [&](size_t, size_t band_start, size_t band_end) {
+            for (size_t b = band_start; b < band_end; ++b) {
+                Dtype* acc = result.row(0, bands.begin(b));
+                time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc);
+                time_reduction::divide(acc, (bands.end(b) - bands.begin(b)) * LON,
+                                       static_cast<Dtype>(T_dim));
             }
         };
 
-        std::vector<std::thread> threads;
-        for (unsigned int i = 0; i < num_threads; ++i) {
-            size_t start = i * lat_per_thread;
-            size_t end = std::min(start + lat_per_thread, LAT);
-            if (start >= LAT) break;
-            threads.emplace_back(worker, start, end);
-        }
-
-        for (auto& th : threads) {
-            th.join();
-        }
+        pool.parallel_for_range(0, bands.count, worker, num_threads);
 
         return result;
     }
 
-    // Rollup: time sum - parallel over lat dimension
-    template<typename Dtype>
-    SimpleCube<Dtype> rollup_time_sum(const SimpleCube<Dtype>& cube, unsigned int num_threads = 0) {
+    // Rollup: time sum - parallel over lat bands
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    SimpleCube<Dtype> rollup_time_sum(const Cube& cube, unsigned int num_threads = 0) {
+        ThreadPool& pool = ThreadPool::instance();
         if (num_threads == 0) {
-            num_threads = std::thread::hardware_concurrency();
-            if (num_threads == 0) num_threads = 4;
+            num_threads = pool.size();
         }
 
-        size_t T_dim = cube.time_dim();
         size_t LAT = cube.lat_dim();
         size_t LON = cube.lon_dim();
 
         SimpleCube<Dtype> result(1, LAT, LON);
+        auto bands = time_reduction::plan<Dtype>(LAT, LON, num_threads);
 
-        size_t lat_per_thread = (LAT + num_threads - 1) / num_threads;
-
-        auto worker = [&](size_t lat_start, size_t lat_end) {
-            for (size_t lat = lat_start; lat < lat_end; ++lat) {
-                for (size_t lon = 0; lon < LON; ++lon) {
-                    Dtype sum = 0;
-                    for (size_t t = 0; t < T_dim; ++t) {
-                        sum += cube.at(t, lat, lon);
-                    }
-                    result.at(0, lat, lon) = sum;
-                }
+        auto worker = [&](size_t, size_t band_start, size_t band_end) {
+            for (size_t b = band_start; b < band_end; ++b) {
+                time_reduction::sum_band(cube, bands.begin(b), bands.end(b),
+                                         result.row(0, bands.begin(b)));
             }
         };
 
-        std::vector<std::thread> threads;
-        for (unsigned int i = 0; i < num_threads; ++i) {
-            size_t start = i * lat_per_thread;
-            size_t end = std::min(start + lat_per_thread, LAT);
-            if (start >= LAT) break;
-            threads.emplace_back(worker, start, end);
-        }
-
-        for (auto& th : threads) {
-            th.join();
-        }
+        pool.parallel_for_range(0, bands.count, worker, num_threads);
 
         return result;
     }
 
-    // Global mean - parallel over time dimension
-    template<typename Dtype>
-    Dtype global_mean(const SimpleCube<Dtype>& cube, unsigned int num_threads = 0) {
+    // Global mean - parallel over lat bands, one partial sum per part
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype global_mean(const Cube& cube, unsigned int num_threads = 0) {
+        ThreadPool& pool = ThreadPool::instance();
         if (num_threads == 0) {
-            num_threads = std::thread::hardware_concurrency();
-            if (num_threads == 0) num_threads = 4;
+            num_threads = pool.size();
         }
 
         size_t T_dim = cube.time_dim();
         size_t LAT = cube.lat_dim();
         size_t LON = cube.lon_dim();
 
+        auto bands = time_reduction::plan<Dtype>(LAT, LON, num_threads);
         std::vector<Dtype> partial_sums(num_threads, 0);
 
-        size_t time_per_thread = (T_dim + num_threads - 1) / num_threads;
-
-        auto worker = [&](size_t t_start, size_t t_end, size_t thread_id) {
+        auto worker = [&](size_t part, size_t band_start, size_t band_end) {
+            std::vector<Dtype, AlignedAllocator<Dtype>> acc(bands.rows * LON);
             Dtype sum = 0;
-            for (size_t t = t_start; t < t_end; ++t) {
-                for (size_t lat = 0; lat < LAT; ++lat) {
-                    for (size_t lon = 0; lon < LON; ++lon) {
-                        sum += cube.at(t, lat, lon);
-                    }
-                }
+            for (size_t b = band_start; b < band_end; ++b) {
+                time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc.data());
+                sum += time_reduction::total(acc.data(), (bands.end(b) - bands.begin(b)) * LON);
             }
-            partial_sums[thread_id] = sum;
+            partial_sums[part] = sum;
         };
 
-        std::vector<std::thread> threads;
-        for (unsigned int i = 0; i < num_threads; ++i) {
-            size_t start = i * time_per_thread;
-            size_t end = std::min(start + time_per_thread, T_dim);
-            if (start >= T_dim) break;
-            threads.emplace_back(worker, start, end, i);
+        pool.parallel_for_range(0, bands.count, worker, num_threads);
+
+        Dtype total_sum = 0;
+        for (size_t i = 0; i < num_threads; ++i) {
+            total_sum += partial_sums[i];
         }
 
-        for (auto& th : threads) {
-            th.join();
+        return total_sum / static_cast<Dtype>(T_dim * LAT * LON);
+    }
+
+    // Region mean - parallel over (t, lat) rows of the box
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype region_mean(const Cube& cube,
+                      size_t t_start, size_t t_end,
+                      size_t lat_start, size_t lat_end,
+                      size_t lon_start, size_t lon_end,
+                      unsigned int num_threads = 0) {
+        if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+            return 0;
+
+        ThreadPool& pool = ThreadPool::instance();
+        if (num_threads == 0) {
+            num_threads = pool.size();
         }
 
+        size_t LAT_box = lat_end - lat_start;
+        size_t rows = (t_end - t_start) * LAT_box;
+
+        std::vector<Dtype> partial_sums(num_threads, 0);
+
+        auto worker = [&](size_t part, size_t row_start, size_t row_end) {
+            Dtype sum = 0;
+            for (size_t r = row_start; r < row_end; ++r) {
+                const Dtype* src = cube.row(t_start + r / LAT_box, lat_start + r % LAT_box);
+                #pragma omp simd reduction(+:sum)
+                for (size_t lon = lon_start; lon < lon_end; ++lon) {
+                    sum += src[lon];
+                }
+            }
+            partial_sums[part] = sum;
+        };
+
+        pool.parallel_for_range(0, rows, worker, num_threads);
+
         Dtype total_sum = 0;
         for (size_t i = 0; i < num_threads; ++i) {
             total_sum += partial_sums[i];
         }
 
-        return total_sum / static_cast<Dtype>(T_dim * LAT * LON);
+        return total_sum / static_cast<Dtype>(rows * (lon_end - lon_start));
     }
 
 } // namespace parallel_olap
@@ -0,0 +1,98 @@
+#pragma once
+#include "../cube/pixel_major_cube.h"
+#include "../cube/simple_cube.h"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Time-axis kernels over PixelMajorCube. Every pixel's series is one
+// contiguous run, so these are flat streaming loops; results match the
+// t-major kernels exactly because each cell still sums t in order.
+namespace pixel_olap {
+
+    // Hourly series of one pixel
+    template<typename Dtype>
+    std::vector<Dtype> timeseries(const PixelMajorCube<Dtype>& cube,
+                                  size_t lat, size_t lon) {
+        const Dtype* src = cube.series(lat, lon);
+        return std::vector<Dtype>(src, src + cube.time_dim());
+    }
+
+    // Hourly mean over a lat/lon box: one contiguous series add per pixel
+    template<typename Dtype>
+    std::vector<Dtype> region_timeseries(const PixelMajorCube<Dtype>& cube,
+                                         size_t lat_start, size_t lat_end,
+                                         size_t lon_start, size_t lon_end) {
+        const size_t T = cube.time_dim();
+        std::vector<Dtype> series(T, 0);
+
+        if (lat_end <= lat_start || lon_end <= lon_start)
+            return series;
+
+        Dtype* acc = series.data();
+
+        for (size_t lat = lat_start; lat < lat_end; ++lat) {
+            for (size_t lon = lon_start; lon < lon_end; ++lon) {
+                const Dtype* src = cube.series(lat, lon);
+
+                #pragma omp simd
+                for (size_t t = 0; t < T; ++t) {
+                    acc[t] += src[t];
+                }
+            }
+        }
+
+        Dtype count = static_cast<Dtype>((lat_end - lat_start) * (lon_end - lon_start));
+
+        #pragma omp simd
+        for (size_t t = 0; t < T; ++t) {
+            acc[t] = acc[t] / count;
+        }
+
+        return series;
+    }
+
+    // Rollup: time sum, one thread per block of pixels
+    template<typename Dtype>
+    SimpleCube<Dtype> rollup_time_sum(const PixelMajorCube<Dtype>& cube) {
+        const size_t T = cube.time_dim();
+        const size_t LON = cube.lon_dim();
+        const size_t P = cube.lat_dim() * LON;
+
+        SimpleCube<Dtype> result(1, cube.lat_dim(), LON);
+        Dtype* out = result.data();
+        const Dtype* in = cube.data();
+
+        #pragma omp parallel for schedule(static)
+        for (size_t p = 0; p < P; ++p) {
+            const Dtype* src = in + p * T;
+            Dtype sum = 0;
+
+            for (size_t t = 0; t < T; ++t) {
+                sum += src[t];
+            }
+
+            out[p] = sum;
+        }
+
+        return result;
+    }
+
+    // Rollup: time mean
+    template<typename Dtype>
+    SimpleCube<Dtype> rollup_time_mean(const PixelMajorCube<Dtype>& cube) {
+        SimpleCube<Dtype> result = rollup_time_sum(cube);
+
+        Dtype* out = result.data();
+        const size_t n = result.size();
+        const Dtype T = static_cast<Dtype>(cube.time_dim());
+
+        #pragma omp parallel for simd schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = out[i] / T;
+        }
+
+        return result;
+    }
+
+} // namespace pixel_olap
@@ -0,0 +1,222 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/quantized_cube.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// OpenMP kernels over QuantizedCube.
+// Each input row is read as 16-bit codes, so rollups and means move half
+// the bytes of the float kernels. fp16 codes are widened in registers as
+// they are accumulated (F16C when compiled in) and summed in float like
+// omp_olap. Scaled int16 codes are summed as integers, which is exact, and
+// scale and offset are applied once per output; the rare shapes that could
+// overflow the integer lanes fall back to widening a float row.
+namespace quant_olap {
+
+//////////////////////////////////////////////////////////////
+// SLICE
+//////////////////////////////////////////////////////////////
+
+// One hour, decoded
+inline SimpleCube<float> slice_time(const QuantizedCube& cube, size_t t)
+{
+    if (t >= cube.time_dim())
+        throw std::out_of_range("Time index out of bounds");
+
+    const size_t LAT = cube.lat_dim();
+    const size_t LON = cube.lon_dim();
+
+    SimpleCube<float> result(1, LAT, LON);
+
+#pragma omp parallel for schedule(static)
+    for (size_t lat = 0; lat < LAT; ++lat)
+        cube.widen_row(t, lat, 0, LON, result.row(0, lat));
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP TIME SUM
+//////////////////////////////////////////////////////////////
+
+// Each thread owns whole output rows and streams the matching input rows
+// hour by hour, as in omp_olap::rollup_time_sum
+inline SimpleCube<float> rollup_time_sum(const QuantizedCube& cube)
+{
+    const size_t T   = cube.time_dim();
+    const size_t LAT = cube.lat_dim();
+    const size_t LON = cube.lon_dim();
+
+    SimpleCube<float> result(1, LAT, LON);
+
+    // int32 lanes hold T codes of magnitude <= 32768 exactly up to 65535 hours
+    if (cube.format() == QuantFormat::ScaledInt16 && T < 65536)
+    {
+        const double scale = cube.scale();
+        const float base = cube.offset() * static_cast<float>(T);
+
+#pragma omp parallel
+        {
+            std::vector<int32_t, AlignedAllocator<int32_t>> acc(LON);
+
+#pragma omp for schedule(static)
+            for (size_t lat = 0; lat < LAT; ++lat)
+            {
+                std::fill(acc.begin(), acc.end(), 0);
+                int32_t* a = acc.data();
+
+                for (size_t t = 0; t < T; ++t)
+                {
+                    const int16_t* src = cube.int_row(t, lat);
+
+                #pragma omp simd
+                    for (size_t lon = 0; lon < LON; ++lon)
+                        a[lon] += src[lon];
+                }
+
+                float* out = result.row(0, lat);
+                for (size_t lon = 0; lon < LON; ++lon)
+                    out[lon] = static_cast<float>(a[lon] * scale) + base;
+            }
+        }
+
+        return result;
+    }
+
+#pragma omp parallel
+    {
+        std::vector<float, AlignedAllocator<float>> row(LON);
+        float* w = row.data();
+
+#pragma omp for schedule(static)
+        for (size_t lat = 0; lat < LAT; ++lat)
+        {
+            float* acc = result.row(0, lat);
+
+            for (size_t t = 0; t < T; ++t)
+            {
+                if (cube.format() == QuantFormat::Half)
+                {
+                    half::accumulate(cube.code_row(t, lat), acc, LON);
+                    continue;
+                }
+
+                cube.widen_row(t, lat, 0, LON, w);
+
+            #pragma omp simd
+                for (size_t lon = 0; lon < LON; ++lon)
+                    acc[lon] += w[lon];
+            }
+        }
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP TIME MEAN
+//////////////////////////////////////////////////////////////
+
+inline SimpleCube<float> rollup_time_mean(const QuantizedCube& cube)
+{
+    SimpleCube<float> result = rollup_time_sum(cube);
+
+    float* out = result.data();
+    const size_t n = result.size();
+    const float T = static_cast<float>(cube.time_dim());
+
+#pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < n; ++i)
+        out[i] = out[i] / T;
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// REGION MEAN
+//////////////////////////////////////////////////////////////
+
+inline float region_mean(const QuantizedCube& cube,
+                         size_t t_start, size_t t_end,
+                         size_t lat_start, size_t lat_end,
+                         size_t lon_start, size_t lon_end)
+{
+    if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+        return 0;
+
+    const size_t n = lon_end - lon_start;
+    const size_t count = (t_end - t_start) * (lat_end - lat_start) * n;
+
+    // Rows are summed in int32 (exact for rows under 65536 cells), the
+    // total in int64
+    if (cube.format() == QuantFormat::ScaledInt16 && n < 65536)
+    {
+        int64_t sum = 0;
+
+#pragma omp parallel for collapse(2) reduction(+:sum) schedule(static)
+        for (size_t t = t_start; t < t_end; ++t)
+        {
+            for (size_t lat = lat_start; lat < lat_end; ++lat)
+            {
+                const int16_t* src = cube.int_row(t, lat) + lon_start;
+                int32_t row_sum = 0;
+
+                #pragma omp simd reduction(+:row_sum)
+                for (size_t i = 0; i < n; ++i)
+                    row_sum += src[i];
+
+                sum += row_sum;
+            }
+        }
+
+        return static_cast<float>(sum * static_cast<double>(cube.scale()) / count)
+             + cube.offset();
+    }
+
+    float sum = 0;
+
+#pragma omp parallel reduction(+:sum)
+    {
+        std::vector<float, AlignedAllocator<float>> row(n);
+        float* w = row.data();
+
+#pragma omp for collapse(2) schedule(static)
+        for (size_t t = t_start; t < t_end; ++t)
+        {
+            for (size_t lat = lat_start; lat < lat_end; ++lat)
+            {
+                if (cube.format() == QuantFormat::Half)
+                {
+                    sum += half::sum(cube.code_row(t, lat) + lon_start, n);
+                    continue;
+                }
+
+                cube.widen_row(t, lat, lon_start, n, w);
+
+                #pragma omp simd reduction(+:sum)
+                for (size_t i = 0; i < n; ++i)
+                    sum += w[i];
+            }
+        }
+    }
+
+    return sum / static_cast<float>(count);
+}
+
+//////////////////////////////////////////////////////////////
+// GLOBAL MEAN
+//////////////////////////////////////////////////////////////
+
+inline float global_mean(const QuantizedCube& cube)
+{
+    return region_mean(cube,
+                       0, cube.time_dim(),
+                       0, cube.lat_dim(),
+                       0, cube.lon_dim());
+}
+
+} // namespace quant_olap
@@ -0,0 +1,472 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/cube_storage.h"
+#include "time_reduction.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+// Fused reductions over any subset of the (t, lat, lon) axes:
+//
+//   using namespace reduce_olap;
+//   auto [peak, hour] = reduce(cube, axis::t, Max{}, ArgMax{});
+//   auto [zonal, spread] = reduce(cube, axis::lon, Mean{}, Std{});
+//
+// Reduced axes keep length 1 in the results, so a time reduction gives a
+// 1 × LAT × LON cube as the rollups do. Every aggregator is fed from the
+// same walk over the input: each row(t, lat) is read from memory once and
+// handed to each aggregator while it is in L1. Kernels are per aggregator
+// and come in two shapes: with lon kept, a row updates LON adjacent
+// outputs lane by lane; with lon reduced, the row folds into one output.
+namespace reduce_olap {
+
+namespace axis {
+    constexpr unsigned t = 1, lat = 2, lon = 4;
+    constexpr unsigned space = lat | lon;
+    constexpr unsigned all = t | lat | lon;
+}
+
+// Input/output geometry of one reduction
+struct Shape {
+    size_t T = 0, LAT = 0, LON = 0;
+    unsigned axes = 0;
+    size_t out_T = 0, out_LAT = 0, out_LON = 0;
+
+    Shape(size_t T_, size_t LAT_, size_t LON_, unsigned axes_)
+        : T(T_), LAT(LAT_), LON(LON_), axes(axes_ & axis::all),
+          out_T(reduces(axis::t) ? 1 : T_),
+          out_LAT(reduces(axis::lat) ? 1 : LAT_),
+          out_LON(reduces(axis::lon) ? 1 : LON_) {}
+
+    bool reduces(unsigned a) const { return (axes & a) != 0; }
+
+    size_t outputs() const { return out_T * out_LAT * out_LON; }
+
+    // Inputs folded into each output
+    size_t count() const {
+        return (reduces(axis::t) ? T : 1) *
+               (reduces(axis::lat) ? LAT : 1) *
+               (reduces(axis::lon) ? LON : 1);
+    }
+
+    // First output fed by row (t, lat)
+    size_t out_index(size_t t, size_t lat) const {
+        return ((reduces(axis::t) ? 0 : t) * out_LAT +
+                (reduces(axis::lat) ? 0 : lat)) * out_LON;
+    }
+
+    // Position of row (t, lat) among the inputs of its output: the
+    // row-major index over the reduced axes, lon (if reduced) excluded
+    size_t position(size_t t, size_t lat) const {
+        size_t pos = reduces(axis::t) ? t : 0;
+        if (reduces(axis::lat)) pos = pos * LAT + lat;
+        if (reduces(axis::lon)) pos = pos * LON;
+        return pos;
+    }
+};
+
+template<typename Dtype>
+using Lanes = std::vector<Dtype, AlignedAllocator<Dtype>>;
+
+//////////////////////////////////////////////////////////////
+// AGGREGATORS
+//////////////////////////////////////////////////////////////
+//
+// Each aggregator has an Acc<Dtype> holding one state per output:
+//   lanes(out, src, n, pos)  outputs out..out+n-1 take src[i], all at pos
+//   row(out, src, n, pos)    output out takes src[0..n), src[i] at pos + i
+//   merge(other)             fold in a partial over the same outputs,
+//                            built from later positions
+//   finish(result, count)    write the result, count inputs per output
+
+struct Sum {
+    template<typename Dtype>
+    struct Acc {
+        using result_type = Dtype;
+        Lanes<Dtype> sum;
+
+        Acc(const Sum&, size_t outputs) : sum(outputs, Dtype(0)) {}
+
+        void lanes(size_t out, const Dtype* src, size_t n, size_t) {
+            Dtype* s = sum.data() + out;
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                s[i] += src[i];
+        }
+
+        void row(size_t out, const Dtype* src, size_t n, size_t) {
+            Dtype s = 0;
+            #pragma omp simd reduction(+:s)
+            for (size_t i = 0; i < n; ++i)
+                s += src[i];
+            sum[out] += s;
+        }
+
+        void merge(const Acc& other) {
+            for (size_t i = 0; i < sum.size(); ++i)
+                sum[i] += other.sum[i];
+        }
+
+        void finish(result_type* result, size_t) const {
+            std::copy(sum.begin(), sum.end(), result);
+        }
+    };
+};
+
+// 0 for an empty reduction
+struct Mean {
+    template<typename Dtype>
+    struct Acc : Sum::Acc<Dtype> {
+        Acc(const Mean&, size_t outputs) : Sum::Acc<Dtype>(Sum(), outputs) {}
+
+        void finish(Dtype* result, size_t count) const {
+            for (size_t i = 0; i < this->sum.size(); ++i)
+                result[i] = count ? this->sum[i] / static_cast<Dtype>(count) : Dtype(0);
+        }
+    };
+};
+
+// Largest value; the lowest representable value for an empty reduction
+struct Max {
+    template<typename Dtype>
+    struct Acc {
+        using result_type = Dtype;
+        Lanes<Dtype> best;
+
+        Acc(const Max&, size_t outputs)
+            : best(outputs, std::numeric_limits<Dtype>::lowest()) {}
+
+        void lanes(size_t out, const Dtype* src, size_t n, size_t) {
+            Dtype* b = best.data() + out;
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                b[i] = std::max(b[i], src[i]);
+        }
+
+        void row(size_t out, const Dtype* src, size_t n, size_t) {
+            Dtype m = best[out];
+            #pragma omp simd reduction(max:m)
+            for (size_t i = 0; i < n; ++i)
+                m = std::max(m, src[i]);
+            best[out] = m;
+        }
+
+        void merge(const Acc& other) {
+            for (size_t i = 0; i < best.size(); ++i)
+                best[i] = std::max(best[i], other.best[i]);
+        }
+
+        void finish(result_type* result, size_t) const {
+            std::copy(best.begin(), best.end(), result);
+        }
+    };
+};
+
+// Smallest value; the largest representable value for an empty reduction
+struct Min {
+    template<typename Dtype>
+    struct Acc {
+        using result_type = Dtype;
+        Lanes<Dtype> best;
+
+        Acc(const Min&, size_t outputs)
+            : best(outputs, std::numeric_limits<Dtype>::max()) {}
+
+        void lanes(size_t out, const Dtype* src, size_t n, size_t) {
+            Dtype* b = best.data() + out;
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                b[i] = std::min(b[i], src[i]);
+        }
+
+        void row(size_t out, const Dtype* src, size_t n, size_t) {
+            Dtype m = best[out];
+            #pragma omp simd reduction(min:m)
+            for (size_t i = 0; i < n; ++i)
+                m = std::min(m, src[i]);
+            best[out] = m;
+        }
+
+        void merge(const Acc& other) {
+            for (size_t i = 0; i < best.size(); ++i)
+                best[i] = std::min(best[i], other.best[i]);
+        }
+
+        void finish(result_type* result, size_t) const {
+            std::copy(best.begin(), best.end(), result);
+        }
+    };
+};
+
+// Position of the first maximum among the reduced axes (Shape::position
+// plus lon when lon is reduced), e.g. the hour of the peak for axis::t.
+// NaN values are skipped; -1 for an empty or all-NaN reduction
+struct ArgMax {
+    template<typename Dtype>
+    struct Acc {
+        using result_type = int64_t;
+        Lanes<Dtype> best;
+        Lanes<int64_t> index;
+
+        Acc(const ArgMax&, size_t outputs)
+            : best(outputs, std::numeric_limits<Dtype>::lowest()), index(outputs, -1) {}
+
+        void lanes(size_t out, const Dtype* src, size_t n, size_t pos) {
+            Dtype* b = best.data() + out;
+            int64_t* x = index.data() + out;
+            const int64_t p = static_cast<int64_t>(pos);
+
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i) {
+                const bool take = src[i] > b[i] || (x[i] < 0 && src[i] == src[i]);
+                b[i] = take ? src[i] : b[i];
+                x[i] = take ? p : x[i];
+            }
+        }
+
+        void row(size_t out, const Dtype* src, size_t n, size_t pos) {
+            if (n == 0)
+                return;
+
+            // One scalar pass, so NaN is skipped exactly as in lanes()
+            size_t first = n;
+            Dtype m = 0;
+            for (size_t i = 0; i < n; ++i)
+                if (src[i] > m || (first == n && src[i] == src[i])) {
+                    m = src[i];
+                    first = i;
+                }
+
+            if (first == n || (index[out] >= 0 && !(m > best[out])))
+                return;
+
+            best[out] = m;
+            index[out] = static_cast<int64_t>(pos + first);
+        }
+
+        // other covers later positions, so ties keep this one
+        void merge(const Acc& other) {
+            for (size_t i = 0; i < best.size(); ++i)
+                if (other.index[i] >= 0 && (index[i] < 0 || other.best[i] > best[i])) {
+                    best[i] = other.best[i];
+                    index[i] = other.index[i];
+                }
+        }
+
+        void finish(result_type* result, size_t) const {
+            std::copy(index.begin(), index.end(), result);
+        }
+    };
+};
+
+// Population standard deviation (divides by n), by Welford's update per
+// lane and Chan's pairwise merge for whole rows and partials; 0 when empty
+struct Std {
+    template<typename Dtype>
+    struct Acc {
+        using result_type = Dtype;
+        Lanes<double> n, mean, m2;
+
+        Acc(const Std&, size_t outputs) : n(outputs, 0.0), mean(outputs, 0.0), m2(outputs, 0.0) {}
+
+        void lanes(size_t out, const Dtype* src, size_t len, size_t) {
+            double* c = n.data() + out;
+            double* mu = mean.data() + out;
+            double* q = m2.data() + out;
+
+            #pragma omp simd
+            for (size_t i = 0; i < len; ++i) {
+                const double x = src[i];
+                c[i] += 1.0;
+                const double delta = x - mu[i];
+                mu[i] += delta / c[i];
+                q[i] += delta * (x - mu[i]);
+            }
+        }
+
+        void combine(size_t out, double n_b, double mean_b, double m2_b) {
+            if (n_b == 0.0)
+                return;
+            const double n_a = n[out];
+            const double total = n_a + n_b;
+            const double delta = mean_b - mean[out];
+            mean[out] += delta * n_b / total;
+            m2[out] += m2_b + delta * delta * n_a * n_b / total;
+            n[out] = total;
+        }
+
+        // Two passes over the row while it is in L1, then one merge
+        void row(size_t out, const Dtype* src, size_t len, size_t) {
+            if (len == 0)
+                return;
+
+            double s = 0.0;
+            #pragma omp simd reduction(+:s)
+            for (size_t i = 0; i < len; ++i)
+                s += src[i];
+            const double mu = s / static_cast<double>(len);
+
+            double q = 0.0;
+            #pragma omp simd reduction(+:q)
+            for (size_t i = 0; i < len; ++i) {
+                const double d = src[i] - mu;
+                q += d * d;
+            }
+
+            combine(out, static_cast<double>(len), mu, q);
+        }
+
+        void merge(const Acc& other) {
+            for (size_t i = 0; i < n.size(); ++i)
+                combine(i, other.n[i], other.mean[i], other.m2[i]);
+        }
+
+        void finish(result_type* result, size_t) const {
+            for (size_t i = 0; i < n.size(); ++i)
+                result[i] = n[i] > 0.0 ? static_cast<Dtype>(std::sqrt(m2[i] / n[i])) : Dtype(0);
+        }
+    };
+};
+
+// Inputs strictly above threshold; by default every input, so Count{0.0f}
+// counts wet cells
+struct Count {
+    double threshold = -std::numeric_limits<double>::infinity();
+
+    Count() = default;
+    explicit Count(double above) : threshold(above) {}
+
+    template<typename Dtype>
+    struct Acc {
+        using result_type = int64_t;
+        Lanes<int64_t> count;
+        double threshold;
+
+        Acc(const Count& c, size_t outputs) : count(outputs, 0), threshold(c.threshold) {}
+
+        void lanes(size_t out, const Dtype* src, size_t n, size_t) {
+            int64_t* c = count.data() + out;
+            const double thr = threshold;
+            #pragma omp simd
+            for (size_t i = 0; i < n; ++i)
+                c[i] += src[i] > thr;
+        }
+
+        void row(size_t out, const Dtype* src, size_t n, size_t) {
+            int64_t c = 0;
+            const double thr = threshold;
+            #pragma omp simd reduction(+:c)
+            for (size_t i = 0; i < n; ++i)
+                c += src[i] > thr;
+            count[out] += c;
+        }
+
+        void merge(const Acc& other) {
+            for (size_t i = 0; i < count.size(); ++i)
+                count[i] += other.count[i];
+        }
+
+        void finish(result_type* result, size_t) const {
+            std::copy(count.begin(), count.end(), result);
+        }
+    };
+};
+
+//////////////////////////////////////////////////////////////
+// REDUCE
+//////////////////////////////////////////////////////////////
+
+// Feed rows [t_start, t_end) × [lat_start, lat_end) to every accumulator
+template<typename Cube, typename Accs>
+void feed(const Cube& cube, const Shape& shape, Accs& accs,
+          size_t t_start, size_t t_end, size_t lat_start, size_t lat_end)
+{
+    const size_t LON = shape.LON;
+    const bool fold_lon = shape.reduces(axis::lon);
+
+    for (size_t t = t_start; t < t_end; ++t)
+        for (size_t lat = lat_start; lat < lat_end; ++lat)
+        {
+            const auto* src = cube.row(t, lat);
+            const size_t out = shape.out_index(t, lat);
+            const size_t pos = shape.position(t, lat);
+
+            std::apply([&](auto&... acc) {
+                if (fold_lon)
+                    (acc.row(out, src, LON, pos), ...);
+                else
+                    (acc.lanes(out, src, LON, pos), ...);
+            }, accs);
+        }
+}
+
+// One pass over a t-major cube or view computing every aggregate over
+// axes (a mask of axis::t, axis::lat, axis::lon). Returns a tuple with
+// one SimpleCube per aggregator, in order.
+//
+// Threads split an axis that is kept when there is one, so each owns
+// distinct outputs: t if kept, otherwise lat. When both are reduced each
+// thread reduces a range of hours into private partials, merged in
+// thread order, so results do not depend on timing.
+template<typename Cube, typename... Aggs>
+auto reduce(const Cube& cube, unsigned axes, const Aggs&... aggs)
+{
+    using Dtype = typename Cube::value_type;
+    using Accs = std::tuple<typename Aggs::template Acc<Dtype>...>;
+
+    const Shape shape(cube.time_dim(), cube.lat_dim(), cube.lon_dim(), axes);
+    const size_t outputs = shape.outputs();
+
+    Accs accs(typename Aggs::template Acc<Dtype>(aggs, outputs)...);
+
+    if (!shape.reduces(axis::t))
+    {
+#pragma omp parallel for schedule(static)
+        for (size_t t = 0; t < shape.T; ++t)
+            feed(cube, shape, accs, t, t + 1, 0, shape.LAT);
+    }
+    else if (!shape.reduces(axis::lat))
+    {
+#pragma omp parallel for schedule(static)
+        for (size_t lat = 0; lat < shape.LAT; ++lat)
+            feed(cube, shape, accs, 0, shape.T, lat, lat + 1);
+    }
+    else
+    {
+        const size_t parts = std::max<size_t>(1, time_reduction::omp_workers());
+        const size_t per = (shape.T + parts - 1) / parts;
+
+        std::vector<Accs> partials;
+        partials.reserve(parts);
+        for (size_t p = 0; p < parts; ++p)
+            partials.emplace_back(typename Aggs::template Acc<Dtype>(aggs, outputs)...);
+
+#pragma omp parallel for schedule(static)
+        for (size_t p = 0; p < parts; ++p)
+        {
+            const size_t t0 = std::min(shape.T, p * per);
+            const size_t t1 = std::min(shape.T, t0 + per);
+            feed(cube, shape, partials[p], t0, t1, 0, shape.LAT);
+        }
+
+        for (auto& partial : partials)
+            std::apply([&](auto&... acc) {
+                std::apply([&](const auto&... part) { (acc.merge(part), ...); }, partial);
+            }, accs);
+    }
+
+    return std::apply([&](const auto&... acc) {
+        return std::make_tuple([&](const auto& a) {
+            using Result = typename std::decay_t<decltype(a)>::result_type;
+            SimpleCube<Result> result(shape.out_T, shape.out_LAT, shape.out_LON);
+            a.finish(result.data(), shape.count());
+            return result;
+        }(acc)...);
+    }, accs);
+}
+
+} // namespace reduce_olap
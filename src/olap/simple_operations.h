@@ -1,54 +1,40 @@
 #pragma once
 #include "../cube/simple_cube.h"
+#include "../cube/cube_view.h"
+#include "time_reduction.h"
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 
+// Sequential kernels. Every inner loop walks one contiguous lon row taken
+// from row(t, lat), so the compiler can vectorize it.
+// Slice and dice return non-owning CubeViews; aggregates accept either a
+// SimpleCube or a view.
 namespace simple_olap {
 
-    // Slice: returns a SimpleCube with single time dimension (1 x LAT x LON)
-    template<typename Dtype>
-    SimpleCube<Dtype> slice_time(const SimpleCube<Dtype>& cube, size_t t) {
-        size_t LAT = cube.lat_dim();
-        size_t LON = cube.lon_dim();
-
-        SimpleCube<Dtype> result(1, LAT, LON);
-
-        for (size_t lat = 0; lat < LAT; ++lat) {
-            for (size_t lon = 0; lon < LON; ++lon) {
-                result.at(0, lat, lon) = cube.at(t, lat, lon);
-            }
-        }
-
-        return result;
+    // Slice: view of a single time step (1 x LAT x LON)
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> slice_time(const Cube& cube, size_t t) {
+        return CubeView<Dtype>(cube).sub(t, t + 1,
+                                         0, cube.lat_dim(),
+                                         0, cube.lon_dim());
     }
 
-    // Dice: returns a sub-cube within specified ranges
-    template<typename Dtype>
-    SimpleCube<Dtype> dice(const SimpleCube<Dtype>& cube,
-                           size_t t_start, size_t t_end,
-                           size_t lat_start, size_t lat_end,
-                           size_t lon_start, size_t lon_end) {
-        size_t newT = t_end - t_start;
-        size_t newLAT = lat_end - lat_start;
-        size_t newLON = lon_end - lon_start;
-
-        SimpleCube<Dtype> result(newT, newLAT, newLON);
-
-        for (size_t t = 0; t < newT; ++t) {
-            for (size_t lat = 0; lat < newLAT; ++lat) {
-                for (size_t lon = 0; lon < newLON; ++lon) {
-                    result.at(t, lat, lon) = cube.at(t + t_start, lat + lat_start, lon + lon_start);
-                }
-            }
-        }
-
-        return result;
+    // Dice: view of a sub-cube within specified ranges
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice(const Cube& cube,
+                         size_t t_start, size_t t_end,
+                         size_t lat_start, size_t lat_end,
+                         size_t lon_start, size_t lon_end) {
+        return CubeView<Dtype>(cube).sub(t_start, t_end,
+                                         lat_start, lat_end,
+                                         lon_start, lon_end);
     }
 
     // Dice by time range only
-    template<typename Dtype>
-    SimpleCube<Dtype> dice_time(const SimpleCube<Dtype>& cube,
-                                size_t t_start, size_t t_end) {
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice_time(const Cube& cube,
+                              size_t t_start, size_t t_end) {
         return dice(cube,
                     t_start, t_end,
                     0, cube.lat_dim(),
@@ -56,104 +42,136 @@ namespace simple_olap {
     }
 
     // Dice by region only
-    template<typename Dtype>
-    SimpleCube<Dtype> dice_region(const SimpleCube<Dtype>& cube,
-                                  size_t lat_start, size_t lat_end,
-                                  size_t lon_start, size_t lon_end) {
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    CubeView<Dtype> dice_region(const Cube& cube,
+                                size_t lat_start, size_t lat_end,
+                                size_t lon_start, size_t lon_end) {
         return dice(cube,
                     0, cube.time_dim(),
                     lat_start, lat_end,
                     lon_start, lon_end);
     }
 
-    // Rollup: time mean (collapses time dimension to 1)
-    template<typename Dtype>
-    SimpleCube<Dtype> rollup_time_mean(const SimpleCube<Dtype>& cube) {
-        size_t T_dim = cube.time_dim();
+    // Rollup: time sum (collapses time dimension to 1)
+    // Band by band on the time_reduction engine; each cell sums t in order
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    SimpleCube<Dtype> rollup_time_sum(const Cube& cube) {
         size_t LAT = cube.lat_dim();
         size_t LON = cube.lon_dim();
 
         SimpleCube<Dtype> result(1, LAT, LON);
+        auto bands = time_reduction::plan<Dtype>(LAT, LON);
 
-        for (size_t lat = 0; lat < LAT; ++lat) {
-            for (size_t lon = 0; lon < LON; ++lon) {
-                Dtype sum = 0;
+        for (size_t b = 0; b < bands.count; ++b) {
+            time_reduction::sum_band(cube, bands.begin(b), bands.end(b),
+                                     result.row(0, bands.begin(b)));
+        }
 
-                for (size_t t = 0; t < T_dim; ++t) {
-                    sum += cube.at(t, lat, lon);
-                }
+        return result;
+    }
 
-                result.at(0, lat, lon) = sum / static_cast<Dtype>(T_dim);
-            }
+    // Rollup: time mean (collapses time dimension to 1)
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    SimpleCube<Dtype> rollup_time_mean(const Cube& cube) {
+        SimpleCube<Dtype> result = rollup_time_sum(cube);
+
+        Dtype* out = result.data();
+        size_t n = result.size();
+        Dtype T_dim = static_cast<Dtype>(cube.time_dim());
+
+        #pragma omp simd
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = out[i] / T_dim;
         }
+
         return result;
     }
 
-    // Rollup: time sum (collapses time dimension to 1)
-    template<typename Dtype>
-    SimpleCube<Dtype> rollup_time_sum(const SimpleCube<Dtype>& cube) {
-        size_t T_dim = cube.time_dim();
-        size_t LAT = cube.lat_dim();
-        size_t LON = cube.lon_dim();
+    // Region mean within specified bounds
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype region_mean(const Cube& cube,
+                      size_t t_start, size_t t_end,
+                      size_t lat_start, size_t lat_end,
+                      size_t lon_start, size_t lon_end) {
+        if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+            return 0;
 
-        SimpleCube<Dtype> result(1, LAT, LON);
+        Dtype sum = 0;
 
-        for (size_t lat = 0; lat < LAT; ++lat) {
-            for (size_t lon = 0; lon < LON; ++lon) {
-                Dtype sum = 0;
+        for (size_t t = t_start; t < t_end; ++t) {
+            for (size_t lat = lat_start; lat < lat_end; ++lat) {
+                const Dtype* src = cube.row(t, lat);
 
-                for (size_t t = 0; t < T_dim; ++t) {
-                    sum += cube.at(t, lat, lon);
+                #pragma omp simd reduction(+:sum)
+                for (size_t lon = lon_start; lon < lon_end; ++lon) {
+                    sum += src[lon];
                 }
-
-                result.at(0, lat, lon) = sum;
             }
         }
 
-        return result;
+        size_t count = (t_end - t_start) * (lat_end - lat_start) * (lon_end - lon_start);
+
+        return sum / static_cast<Dtype>(count);
     }
 
-    // Global mean across all dimensions
-    template<typename Dtype>
-    Dtype global_mean(const SimpleCube<Dtype>& cube) {
+    // Global mean across all dimensions: band sums over time, then over the band
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    Dtype global_mean(const Cube& cube) {
         size_t T_dim = cube.time_dim();
         size_t LAT = cube.lat_dim();
         size_t LON = cube.lon_dim();
+        if (T_dim * LAT * LON == 0)
+            return 0;
 
-        Dtype sum = 0;
+        auto bands = time_reduction::plan<Dtype>(LAT, LON);
+        std::vector<Dtype, AlignedAllocator<Dtype>> acc(bands.rows * LON);
 
-        for (size_t t = 0; t < T_dim; ++t) {
-            for (size_t lat = 0; lat < LAT; ++lat) {
-                for (size_t lon = 0; lon < LON; ++lon) {
-                    sum += cube.at(t, lat, lon);
-                }
-            }
+        Dtype sum = 0;
+        for (size_t b = 0; b < bands.count; ++b) {
+            time_reduction::sum_band(cube, bands.begin(b), bands.end(b), acc.data());
+            sum += time_reduction::total(acc.data(), (bands.end(b) - bands.begin(b)) * LON);
         }
 
         return sum / static_cast<Dtype>(T_dim * LAT * LON);
     }
 
-    // Region mean within specified bounds
-    template<typename Dtype>
-    Dtype region_mean(const SimpleCube<Dtype>& cube,
-                      size_t t_start, size_t t_end,
-                      size_t lat_start, size_t lat_end,
-                      size_t lon_start, size_t lon_end) {
-        Dtype sum = 0;
-        size_t count = 0;
+    // Hourly series of one pixel; strided by LAT x LON in this layout
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    std::vector<Dtype> timeseries(const Cube& cube,
+                                  size_t lat, size_t lon) {
+        std::vector<Dtype> series(cube.time_dim());
 
-        for (size_t t = t_start; t < t_end; ++t) {
+        for (size_t t = 0; t < cube.time_dim(); ++t) {
+            series[t] = cube.row(t, lat)[lon];
+        }
+
+        return series;
+    }
+
+    // Hourly mean over a lat/lon box
+    template<typename Cube, typename Dtype = typename Cube::value_type>
+    std::vector<Dtype> region_timeseries(const Cube& cube,
+                                         size_t lat_start, size_t lat_end,
+                                         size_t lon_start, size_t lon_end) {
+        std::vector<Dtype> series(cube.time_dim(), 0);
+
+        if (lat_end <= lat_start || lon_end <= lon_start)
+            return series;
+
+        Dtype count = static_cast<Dtype>((lat_end - lat_start) * (lon_end - lon_start));
+
+        for (size_t t = 0; t < cube.time_dim(); ++t) {
+            Dtype sum = 0;
             for (size_t lat = lat_start; lat < lat_end; ++lat) {
+                const Dtype* src = cube.row(t, lat);
                 for (size_t lon = lon_start; lon < lon_end; ++lon) {
-                    sum += cube.at(t, lat, lon);
-                    ++count;
+                    sum += src[lon];
                 }
             }
+            series[t] = sum / count;
         }
 
-        if (count == 0) return 0;
-
-        return sum / static_cast<Dtype>(count);
+        return series;
     }
 
 } // namespace simple_olap
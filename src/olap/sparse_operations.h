@@ -0,0 +1,161 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/sparse_cube.h"
+#include <omp.h>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// OpenMP kernels over SparseCube.
+// Every loop walks stored (non-zero) cells only, so work scales with the
+// non-zeros plus one offset read per (t, lat) row. Absent cells are zero,
+// so sums skip them and means still divide by the full cell count. Slices
+// and rollups match the dense kernels exactly; global_mean and region_mean
+// sum in a different order and agree only up to float rounding.
+namespace sparse_olap {
+
+//////////////////////////////////////////////////////////////
+// SLICE
+//////////////////////////////////////////////////////////////
+
+// One hour as a single-plane sparse cube: copies that hour's CSR rows
+template<typename Dtype>
+SparseCube<Dtype> slice_time(const SparseCube<Dtype>& cube, size_t t)
+{
+    if (t >= cube.time_dim())
+        throw std::out_of_range("Time index out of bounds");
+
+    const size_t LAT = cube.lat_dim();
+    if (LAT == 0)
+        return SparseCube<Dtype>(1, 0, cube.lon_dim());
+
+    const size_t first = cube.row_begin(t, 0);
+    const size_t last = cube.row_end(t, LAT - 1);
+
+    std::vector<size_t> starts(LAT + 1);
+    for (size_t lat = 0; lat < LAT; ++lat)
+        starts[lat] = cube.row_begin(t, lat) - first;
+    starts[LAT] = last - first;
+
+    using Index = typename SparseCube<Dtype>::index_type;
+    std::vector<Index> lons(cube.lon_indices() + first, cube.lon_indices() + last);
+    std::vector<Dtype> vals(cube.data() + first, cube.data() + last);
+
+    return SparseCube<Dtype>(1, LAT, cube.lon_dim(),
+                             std::move(starts), std::move(lons), std::move(vals));
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP TIME SUM
+//////////////////////////////////////////////////////////////
+
+// Each thread owns whole output rows and scatters the matching sparse
+// rows into them hour by hour, so every cell still sums t in order
+template<typename Dtype>
+SimpleCube<Dtype> rollup_time_sum(const SparseCube<Dtype>& cube)
+{
+    const size_t T   = cube.time_dim();
+    const size_t LAT = cube.lat_dim();
+
+    SimpleCube<Dtype> result(1, LAT, cube.lon_dim());
+
+    const auto* lons = cube.lon_indices();
+    const Dtype* vals = cube.data();
+
+#pragma omp parallel for schedule(static)
+    for (size_t lat = 0; lat < LAT; ++lat)
+    {
+        Dtype* acc = result.row(0, lat);
+
+        for (size_t t = 0; t < T; ++t)
+        {
+            const size_t end = cube.row_end(t, lat);
+            for (size_t k = cube.row_begin(t, lat); k < end; ++k)
+                acc[lons[k]] += vals[k];
+        }
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP TIME MEAN
+//////////////////////////////////////////////////////////////
+
+template<typename Dtype>
+SimpleCube<Dtype> rollup_time_mean(const SparseCube<Dtype>& cube)
+{
+    SimpleCube<Dtype> result = rollup_time_sum(cube);
+
+    Dtype* out = result.data();
+    const size_t n = result.size();
+    const Dtype T = static_cast<Dtype>(cube.time_dim());
+
+#pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < n; ++i)
+        out[i] = out[i] / T;
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// GLOBAL MEAN
+//////////////////////////////////////////////////////////////
+
+// The values array is every non-zero cell, so this is one flat sum
+template<typename Dtype>
+Dtype global_mean(const SparseCube<Dtype>& cube)
+{
+    const Dtype* in = cube.data();
+    const size_t n = cube.nnz();
+
+    Dtype sum = 0;
+
+#pragma omp parallel for simd reduction(+:sum) schedule(static)
+    for (size_t i = 0; i < n; ++i)
+        sum += in[i];
+
+    return cube.size() ? sum / static_cast<Dtype>(cube.size()) : Dtype(0);
+}
+
+//////////////////////////////////////////////////////////////
+// REGION MEAN
+//////////////////////////////////////////////////////////////
+
+// Per row, binary-search the first stored lon in range and sum forward
+template<typename Dtype>
+Dtype region_mean(const SparseCube<Dtype>& cube,
+                  size_t t_start, size_t t_end,
+                  size_t lat_start, size_t lat_end,
+                  size_t lon_start, size_t lon_end)
+{
+    if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+        return 0;
+
+    const auto* lons = cube.lon_indices();
+    const Dtype* vals = cube.data();
+
+    Dtype sum = 0;
+
+#pragma omp parallel for collapse(2) reduction(+:sum) schedule(static)
+    for (size_t t = t_start; t < t_end; ++t)
+    {
+        for (size_t lat = lat_start; lat < lat_end; ++lat)
+        {
+            const size_t end = cube.row_end(t, lat);
+            for (size_t k = cube.lower_bound(t, lat, lon_start);
+                 k < end && lons[k] < lon_end; ++k)
+                sum += vals[k];
+        }
+    }
+
+    size_t count =
+        (t_end - t_start) *
+        (lat_end - lat_start) *
+        (lon_end - lon_start);
+
+    return sum / static_cast<Dtype>(count);
+}
+
+} // namespace sparse_olap
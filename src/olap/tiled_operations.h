@@ -0,0 +1,265 @@
+#pragma once
+#include "../cube/simple_cube.h"
+#include "../cube/tiled_cube.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// OpenMP kernels over TiledCube.
+// Work is split by tile, and every inner loop runs over a contiguous tile
+// row or tile plane. Results that collapse time come back as row-major
+// SimpleCube planes; dice keeps the tiled layout.
+namespace tiled_olap {
+
+//////////////////////////////////////////////////////////////
+// SLICE
+//////////////////////////////////////////////////////////////
+
+template<typename Dtype>
+SimpleCube<Dtype> slice_time(const TiledCube<Dtype>& cube, size_t t)
+{
+    const TileShape& shape = cube.tile_shape();
+    const size_t bt = t / shape.t;
+    const size_t it = t % shape.t;
+
+    SimpleCube<Dtype> result(1, cube.lat_dim(), cube.lon_dim());
+
+#pragma omp parallel for collapse(2) schedule(static)
+    for (size_t bl = 0; bl < cube.tiles_lat_dim(); ++bl)
+    {
+        for (size_t bo = 0; bo < cube.tiles_lon_dim(); ++bo)
+        {
+            const Dtype* plane = cube.tile(bt, bl, bo) + it * shape.plane();
+            const size_t nl = cube.tile_lat_extent(bl);
+            const size_t no = cube.tile_lon_extent(bo);
+
+            for (size_t il = 0; il < nl; ++il)
+            {
+                const Dtype* src = plane + il * shape.lon;
+                Dtype* dst = result.row(0, bl * shape.lat + il) + bo * shape.lon;
+                std::copy(src, src + no, dst);
+            }
+        }
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// DICE
+//////////////////////////////////////////////////////////////
+
+template<typename Dtype>
+TiledCube<Dtype> dice(const TiledCube<Dtype>& cube,
+                      size_t t_start, size_t t_end,
+                      size_t lat_start, size_t lat_end,
+                      size_t lon_start, size_t lon_end)
+{
+    size_t newT   = t_end - t_start;
+    size_t newLAT = lat_end - lat_start;
+    size_t newLON = lon_end - lon_start;
+
+    TiledCube<Dtype> result(newT, newLAT, newLON, cube.tile_shape());
+
+    const size_t tile_lon = result.tile_shape().lon;
+
+    // Each destination tile row segment is filled straight from the source
+#pragma omp parallel for schedule(static)
+    for (size_t t = 0; t < newT; ++t)
+    {
+        for (size_t lat = 0; lat < newLAT; ++lat)
+        {
+            for (size_t lon = 0; lon < newLON; lon += tile_lon)
+            {
+                size_t len = std::min(tile_lon, newLON - lon);
+                cube.read_row(t + t_start, lat + lat_start, lon_start + lon, len,
+                              &result.at(t, lat, lon));
+            }
+        }
+    }
+
+    return result;
+}
+
+template<typename Dtype>
+TiledCube<Dtype> dice_time(const TiledCube<Dtype>& cube,
+                           size_t t_start, size_t t_end)
+{
+    return dice(cube,
+                t_start, t_end,
+                0, cube.lat_dim(),
+                0, cube.lon_dim());
+}
+
+template<typename Dtype>
+TiledCube<Dtype> dice_region(const TiledCube<Dtype>& cube,
+                             size_t lat_start, size_t lat_end,
+                             size_t lon_start, size_t lon_end)
+{
+    return dice(cube,
+                0, cube.time_dim(),
+                lat_start, lat_end,
+                lon_start, lon_end);
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP TIME SUM
+//////////////////////////////////////////////////////////////
+
+// Each thread owns whole spatial tile columns: it sums their tile.t planes
+// into a private tile-sized accumulator (one flat simd loop per plane),
+// then writes the valid part out once. Cells still sum t in order.
+template<typename Dtype>
+SimpleCube<Dtype> rollup_time_sum(const TiledCube<Dtype>& cube)
+{
+    const TileShape& shape = cube.tile_shape();
+    const size_t plane = shape.plane();
+
+    SimpleCube<Dtype> result(1, cube.lat_dim(), cube.lon_dim());
+
+#pragma omp parallel
+    {
+        std::vector<Dtype, AlignedAllocator<Dtype>> acc(plane);
+
+#pragma omp for collapse(2) schedule(static)
+        for (size_t bl = 0; bl < cube.tiles_lat_dim(); ++bl)
+        {
+            for (size_t bo = 0; bo < cube.tiles_lon_dim(); ++bo)
+            {
+                std::fill(acc.begin(), acc.end(), Dtype{});
+                Dtype* a = acc.data();
+
+                for (size_t bt = 0; bt < cube.tiles_time(); ++bt)
+                {
+                    const Dtype* tile = cube.tile(bt, bl, bo);
+                    const size_t nt = cube.tile_t_extent(bt);
+
+                    for (size_t it = 0; it < nt; ++it)
+                    {
+                        const Dtype* src = tile + it * plane;
+
+                    #pragma omp simd
+                        for (size_t k = 0; k < plane; ++k)
+                            a[k] += src[k];
+                    }
+                }
+
+                const size_t nl = cube.tile_lat_extent(bl);
+                const size_t no = cube.tile_lon_extent(bo);
+
+                for (size_t il = 0; il < nl; ++il)
+                {
+                    const Dtype* src = a + il * shape.lon;
+                    Dtype* dst = result.row(0, bl * shape.lat + il) + bo * shape.lon;
+                    std::copy(src, src + no, dst);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// ROLLUP TIME MEAN
+//////////////////////////////////////////////////////////////
+
+template<typename Dtype>
+SimpleCube<Dtype> rollup_time_mean(const TiledCube<Dtype>& cube)
+{
+    SimpleCube<Dtype> result = rollup_time_sum(cube);
+
+    Dtype* out = result.data();
+    const size_t n = result.size();
+    const Dtype T = static_cast<Dtype>(cube.time_dim());
+
+#pragma omp parallel for simd schedule(static)
+    for (size_t i = 0; i < n; ++i)
+        out[i] = out[i] / T;
+
+    return result;
+}
+
+//////////////////////////////////////////////////////////////
+// GLOBAL MEAN
+//////////////////////////////////////////////////////////////
+
+// Padding cells are zero, so the whole tile buffer can be summed flat
+template<typename Dtype>
+Dtype global_mean(const TiledCube<Dtype>& cube)
+{
+    const Dtype* in = cube.data();
+    const size_t n = cube.storage_size();
+
+    Dtype sum = 0;
+
+#pragma omp parallel for simd reduction(+:sum) schedule(static)
+    for (size_t i = 0; i < n; ++i)
+        sum += in[i];
+
+    return sum / static_cast<Dtype>(cube.time_dim() * cube.lat_dim() * cube.lon_dim());
+}
+
+//////////////////////////////////////////////////////////////
+// REGION MEAN
+//////////////////////////////////////////////////////////////
+
+// Visits only the tiles overlapping the region, clipped to its bounds
+template<typename Dtype>
+Dtype region_mean(const TiledCube<Dtype>& cube,
+                  size_t t_start, size_t t_end,
+                  size_t lat_start, size_t lat_end,
+                  size_t lon_start, size_t lon_end)
+{
+    if (t_end <= t_start || lat_end <= lat_start || lon_end <= lon_start)
+        return 0;
+
+    const TileShape& shape = cube.tile_shape();
+
+    const size_t bt0 = t_start / shape.t,     bt1 = (t_end - 1) / shape.t + 1;
+    const size_t bl0 = lat_start / shape.lat, bl1 = (lat_end - 1) / shape.lat + 1;
+    const size_t bo0 = lon_start / shape.lon, bo1 = (lon_end - 1) / shape.lon + 1;
+
+    Dtype sum = 0;
+
+#pragma omp parallel for collapse(3) reduction(+:sum) schedule(static)
+    for (size_t bt = bt0; bt < bt1; ++bt)
+    {
+        for (size_t bl = bl0; bl < bl1; ++bl)
+        {
+            for (size_t bo = bo0; bo < bo1; ++bo)
+            {
+                const Dtype* tile = cube.tile(bt, bl, bo);
+
+                const size_t it0 = std::max(t_start, bt * shape.t) - bt * shape.t;
+                const size_t it1 = std::min(t_end, (bt + 1) * shape.t) - bt * shape.t;
+                const size_t il0 = std::max(lat_start, bl * shape.lat) - bl * shape.lat;
+                const size_t il1 = std::min(lat_end, (bl + 1) * shape.lat) - bl * shape.lat;
+                const size_t io0 = std::max(lon_start, bo * shape.lon) - bo * shape.lon;
+                const size_t io1 = std::min(lon_end, (bo + 1) * shape.lon) - bo * shape.lon;
+
+                for (size_t it = it0; it < it1; ++it)
+                {
+                    for (size_t il = il0; il < il1; ++il)
+                    {
+                        const Dtype* src = tile + (it * shape.lat + il) * shape.lon;
+
+                    #pragma omp simd reduction(+:sum)
+                        for (size_t io = io0; io < io1; ++io)
+                            sum += src[io];
+                    }
+                }
+            }
+        }
+    }
+
+    size_t count =
+        (t_end - t_start) *
+        (lat_end - lat_start) *
+        (lon_end - lon_start);
+
+    return sum / static_cast<Dtype>(count);
+}
+
+} // namespace tiled_olap
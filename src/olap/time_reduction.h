@@ -0,0 +1,152 @@
+#pragma once
+#include "../cube/validity_mask.h"
+#include <omp.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Shared engine for reductions along the time axis of a t-major cube.
+// The lat × lon plane is cut into bands of consecutive lat rows whose
+// accumulators fit in L1. A band is summed over every hour by one
+// thread, start to finish, so a parallel rollup needs no barrier per
+// hour and never streams the whole accumulator plane through memory.
+// Every cell still sums t in order, so all backends that drive the
+// engine (olap, simple_olap, parallel_olap, omp_olap) agree bit for bit
+// on rollups.
+namespace time_reduction {
+
+// Accumulator bytes per band: half of a 32 KiB L1d, leaving the other
+// half for the input rows streaming through
+constexpr std::size_t kBandBytes = 16 * 1024;
+
+struct Bands {
+    std::size_t lat_dim = 0;
+    std::size_t rows = 1;      // lat rows per band
+    std::size_t count = 0;
+
+    std::size_t begin(std::size_t band) const { return band * rows; }
+    std::size_t end(std::size_t band) const { return std::min(lat_dim, (band + 1) * rows); }
+};
+
+// Bands of at most kBandBytes of accumulators. With several workers the
+// band count is rounded up to a multiple of them, so a static split
+// gives every worker the same number of rows (± one band).
+template<typename Dtype>
+Bands plan(std::size_t LAT, std::size_t LON, unsigned int workers = 1)
+{
+    Bands bands;
+    bands.lat_dim = LAT;
+    if (LAT == 0)
+        return bands;
+
+    const std::size_t row_bytes = std::max<std::size_t>(1, LON) * sizeof(Dtype);
+    std::size_t rows = std::max<std::size_t>(1, kBandBytes / row_bytes);
+    std::size_t count = (LAT + rows - 1) / rows;
+
+    if (workers > 1) {
+        count = (count + workers - 1) / workers * workers;
+        rows = std::max<std::size_t>(1, (LAT + count - 1) / count);
+    }
+
+    bands.rows = rows;
+    bands.count = (LAT + rows - 1) / rows;
+    return bands;
+}
+
+// Threads an OpenMP parallel region would use; 1 when built without OpenMP
+inline unsigned int omp_workers()
+{
+#if defined(_OPENMP)
+    return static_cast<unsigned int>(omp_get_max_threads());
+#else
+    return 1;
+#endif
+}
+
+// acc[(lat - lat_start) * LON + lon] = sum over t of cube(t, lat, lon).
+// Rows of a full-width cube or view are contiguous, so each hour is one
+// simd pass over the band; otherwise one pass per row.
+template<typename Cube, typename Dtype = typename Cube::value_type>
+void sum_band(const Cube& cube, std::size_t lat_start, std::size_t lat_end, Dtype* acc)
+{
+    const std::size_t T = cube.time_dim();
+    const std::size_t LON = cube.lon_dim();
+    const std::size_t rows = lat_end - lat_start;
+    const std::size_t n = rows * LON;
+
+    std::fill(acc, acc + n, Dtype(0));
+    if (T == 0 || n == 0)
+        return;
+
+    const bool contiguous =
+        rows == 1 || cube.row(0, lat_start + 1) == cube.row(0, lat_start) + LON;
+
+    for (std::size_t t = 0; t < T; ++t)
+    {
+        if (contiguous)
+        {
+            const Dtype* src = cube.row(t, lat_start);
+
+#pragma omp simd
+            for (std::size_t i = 0; i < n; ++i)
+                acc[i] += src[i];
+            continue;
+        }
+
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const Dtype* src = cube.row(t, lat_start + r);
+            Dtype* a = acc + r * LON;
+
+#pragma omp simd
+            for (std::size_t lon = 0; lon < LON; ++lon)
+                a[lon] += src[lon];
+        }
+    }
+}
+
+// count[(lat - lat_start) * LON + lon] = hours observed at (lat, lon);
+// zero words are skipped and set bits visited one at a time
+inline void count_band(const ValidityMask& valid,
+                       std::size_t lat_start, std::size_t lat_end, int32_t* count)
+{
+    const std::size_t LON = valid.lon_dim();
+    const std::size_t words = valid.words_per_row();
+
+    std::fill(count, count + (lat_end - lat_start) * LON, 0);
+
+    for (std::size_t t = 0; t < valid.time_dim(); ++t)
+        for (std::size_t lat = lat_start; lat < lat_end; ++lat)
+        {
+            const uint64_t* bits = valid.row(t, lat);
+            int32_t* c = count + (lat - lat_start) * LON;
+
+            for (std::size_t w = 0; w < words; ++w)
+                for (uint64_t word = bits[w]; word; word &= word - 1)
+                    ++c[w * 64 + ctz64(word)];
+        }
+}
+
+// Sum of n band accumulators
+template<typename Dtype>
+Dtype total(const Dtype* acc, std::size_t n)
+{
+    Dtype sum = 0;
+
+#pragma omp simd reduction(+:sum)
+    for (std::size_t i = 0; i < n; ++i)
+        sum += acc[i];
+
+    return sum;
+}
+
+// acc[i] /= divisor
+template<typename Dtype, typename Divisor>
+void divide(Dtype* acc, std::size_t n, Divisor divisor)
+{
+#pragma omp simd
+    for (std::size_t i = 0; i < n; ++i)
+        acc[i] = acc[i] / divisor;
+}
+
+} // namespace time_reduction
@@ -0,0 +1,28 @@
+#pragma once
+
+// Relaxed atomic read-modify-write on plain memory.
+// Stand-in for C++20 std::atomic_ref<T>::fetch_add while the tree builds
+// as C++17: the GCC/Clang __atomic builtins operate on ordinary float/int
+// cube cells without changing their storage type.
+namespace atomic_ops {
+
+inline void fetch_add(int& target, int value)
+{
+    __atomic_fetch_add(&target, value, __ATOMIC_RELAXED);
+}
+
+inline void fetch_add(float& target, float value)
+{
+    float expected;
+    __atomic_load(&target, &expected, __ATOMIC_RELAXED);
+
+    float desired;
+    do {
+        desired = expected + value;
+    } while (!__atomic_compare_exchange(&target, &expected, &desired,
+                                        true,
+                                        __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED));
+}
+
+} // namespace atomic_ops
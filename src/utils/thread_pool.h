@@ -0,0 +1,273 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Persistent worker threads behind one FIFO task queue.
+// submit() queues a task and returns its future. parallel_for() is
+// fork/join: it queues helpers, runs iterations on the calling thread as
+// well, and returns once every iteration has finished, so a small query
+// pays a queue push and a wake-up instead of thread creation. Because the
+// caller claims iterations too, parallel_for also works from inside a pool
+// task and on a pool with no workers.
+//
+// size() counts the caller: a pool of size N keeps N - 1 workers.
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    bool stopping = false;
+    bool pin_workers = false;
+
+    // Shared by the helpers of one parallel_for; a helper that wakes after
+    // the join only touches the cursor, which the shared_ptr keeps alive
+    struct Job {
+        std::size_t n = 0;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::function<void(std::size_t)> body;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable cv;
+
+        void run()
+        {
+            for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n; )
+            {
+                try {
+                    body(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+
+                if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == n)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cv.notify_all();
+                }
+            }
+        }
+    };
+
+    void worker_loop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [&] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+
+    // Worker w on core w + 1, leaving core 0 to the main thread
+    void pin(std::thread& th, std::size_t w)
+    {
+#if defined(__linux__)
+        unsigned int cores = std::thread::hardware_concurrency();
+        if (cores == 0)
+            return;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET((w + 1) % cores, &set);
+        pthread_setaffinity_np(th.native_handle(), sizeof(set), &set);
+#else
+        (void)th;
+        (void)w;
+#endif
+    }
+
+    void push(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(std::move(task));
+        }
+        queue_cv.notify_one();
+    }
+
+    static std::unique_ptr<ThreadPool>& global_slot()
+    {
+        static std::unique_ptr<ThreadPool> pool;
+        return pool;
+    }
+
+    static std::mutex& global_mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+
+public:
+    // threads: total concurrency including the caller, 0 = hardware threads
+    // pin_threads: bind each worker to one core (Linux only, ignored elsewhere)
+    explicit ThreadPool(unsigned int threads = 0, bool pin_threads = false)
+        : pin_workers(pin_threads)
+    {
+        if (threads == 0) {
+            threads = std::thread::hardware_concurrency();
+            if (threads == 0) threads = 4;
+        }
+
+        workers.reserve(threads - 1);
+        for (unsigned int w = 0; w + 1 < threads; ++w)
+        {
+            workers.emplace_back([this] { worker_loop(); });
+            if (pin_threads)
+                pin(workers.back(), w);
+        }
+    }
+
+    // Finishes queued tasks, then joins the workers
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cv.notify_all();
+
+        for (auto& th : workers)
+            th.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool shared by the loader, builders and parallel_olap.
+    // Created on first use with GPMCUBE_THREADS threads (default: hardware
+    // threads), pinned if GPMCUBE_PIN_THREADS is set to a non-zero value.
+    static ThreadPool& instance()
+    {
+        std::lock_guard<std::mutex> lock(global_mutex());
+        auto& pool = global_slot();
+
+        if (!pool)
+        {
+            const char* threads = std::getenv("GPMCUBE_THREADS");
+            const char* pinned = std::getenv("GPMCUBE_PIN_THREADS");
+
+            pool.reset(new ThreadPool(
+                threads ? static_cast<unsigned int>(std::strtoul(threads, nullptr, 10)) : 0,
+                pinned && std::atoi(pinned) != 0));
+        }
+
+        return *pool;
+    }
+
+    // Replace the process-wide pool. Call it between parallel sections
+    // (e.g. at startup): references from earlier instance() calls dangle.
+    static void configure(unsigned int threads, bool pin_threads = false)
+    {
+        std::unique_ptr<ThreadPool> old;
+        {
+            std::lock_guard<std::mutex> lock(global_mutex());
+            old = std::move(global_slot());
+            global_slot().reset(new ThreadPool(threads, pin_threads));
+        }
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(workers.size()) + 1; }
+    bool pinned() const { return pin_workers; }
+
+    // Queue fn on a worker. Without workers it runs before submit returns.
+    template<typename Fn>
+    auto submit(Fn&& fn) -> std::future<std::invoke_result_t<std::decay_t<Fn>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<Fn>>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> result = task->get_future();
+
+        if (workers.empty())
+            (*task)();
+        else
+            push([task] { (*task)(); });
+
+        return result;
+    }
+
+    // fn(i) for every i in [0, n), each on some pool thread or the caller.
+    // Returns when all have finished; rethrows the first exception thrown.
+    template<typename Fn>
+    void parallel_for(std::size_t n, Fn&& fn)
+    {
+        if (n == 0)
+            return;
+
+        if (n == 1 || workers.empty())
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                fn(i);
+            return;
+        }
+
+        auto job = std::make_shared<Job>();
+        job->n = n;
+        job->body = [&fn](std::size_t i) { fn(i); };
+
+        const std::size_t helpers = std::min(workers.size(), n - 1);
+        for (std::size_t h = 0; h < helpers; ++h)
+            push([job] { job->run(); });
+
+        job->run();
+
+        {
+            std::unique_lock<std::mutex> lock(job->mutex);
+            job->cv.wait(lock, [&] {
+                return job->done.load(std::memory_order_acquire) == n;
+            });
+        }
+
+        if (job->error)
+            std::rethrow_exception(job->error);
+    }
+
+    // fn(part, begin, end) over [begin, end) split into parts contiguous
+    // ranges (0 = size()); empty ranges are skipped
+    template<typename Fn>
+    void parallel_for_range(std::size_t begin, std::size_t end, Fn&& fn,
+                            std::size_t parts = 0)
+    {
+        if (end <= begin)
+            return;
+        if (parts == 0)
+            parts = size();
+
+        const std::size_t n = end - begin;
+        const std::size_t per_part = (n + parts - 1) / parts;
+        const std::size_t used = (n + per_part - 1) / per_part;
+
+        parallel_for(used, [&](std::size_t p) {
+            const std::size_t lo = begin + p * per_part;
+            fn(p, lo, std::min(lo + per_part, end));
+        });
+    }
+};
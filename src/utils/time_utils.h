@@ -0,0 +1,109 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Hour-resolution timestamps as int32 hours since 1970-01-01T00 (UTC).
+// GPM timestamps are fixed-width "YYYY-MM-DDTHH:MM:SS..." byte strings, so
+// the hour key can be parsed in place without building std::strings.
+namespace timeutil {
+
+constexpr int32_t kInvalidHour = std::numeric_limits<int32_t>::min();
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant)
+inline int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// Inverse of days_from_civil
+inline void civil_from_days(int64_t z, int& y, unsigned& m, unsigned& d)
+{
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+}
+
+inline bool parse_digits(const char* s, size_t n, unsigned& out)
+{
+    out = 0;
+    for (size_t i = 0; i < n; ++i) {
+        unsigned c = static_cast<unsigned char>(s[i]) - '0';
+        if (c > 9) return false;
+        out = out * 10 + c;
+    }
+    return true;
+}
+
+// Parse the "YYYY-MM-DDTHH" prefix of s.
+// Returns kInvalidHour for short or malformed input (e.g. zero-filled
+// bytes of a missing chunk).
+inline int32_t parse_epoch_hour(const char* s, size_t len)
+{
+    if (len < 13 || s[4] != '-' || s[7] != '-' ||
+        (s[10] != 'T' && s[10] != ' '))
+        return kInvalidHour;
+
+    unsigned y, m, d, h;
+    if (!parse_digits(s, 4, y) || !parse_digits(s + 5, 2, m) ||
+        !parse_digits(s + 8, 2, d) || !parse_digits(s + 11, 2, h))
+        return kInvalidHour;
+
+    if (m < 1 || m > 12 || d < 1 || d > 31 || h > 23)
+        return kInvalidHour;
+
+    return static_cast<int32_t>(days_from_civil(y, m, d) * 24 + h);
+}
+
+inline int32_t parse_epoch_hour(const std::string& s)
+{
+    return parse_epoch_hour(s.data(), s.size());
+}
+
+// Day since 1970-01-01 and hour of day (0-23) of an epoch hour
+inline int64_t day_of(int32_t hour) { return hour >= 0 ? hour / 24 : (hour - 23) / 24; }
+inline unsigned hour_of_day(int32_t hour) { return static_cast<unsigned>(hour - day_of(hour) * 24); }
+
+// Format as the "YYYY-MM-DDTHH" hour key
+inline std::string format_hour(int32_t hour)
+{
+    if (hour == kInvalidHour)
+        return "invalid";
+
+    int64_t days = day_of(hour);
+    unsigned h = hour_of_day(hour);
+
+    int y;
+    unsigned m, d;
+    civil_from_days(days, y, m, d);
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%04d-%02u-%02uT%02u", y, m, d, h);
+    return buf;
+}
+
+inline std::vector<int32_t> to_epoch_hours(const std::vector<std::string>& timestamps)
+{
+    std::vector<int32_t> hours(timestamps.size());
+
+    for (size_t i = 0; i < timestamps.size(); ++i)
+        hours[i] = parse_epoch_hour(timestamps[i]);
+
+    return hours;
+}
+
+} // namespace timeutil
@@ -1,8 +1,44 @@
 #include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
 
 #include "../src/cube/datacube.h"
+#include "../src/cube/simple_cube.h"
+#include "../src/cube/tiled_cube.h"
+#include "../src/cube/prefix_sum_index.h"
+#include "../src/olap/pixel_operations.h"
+#include "../src/olap/sparse_operations.h"
+#include "../src/olap/quantized_operations.h"
+#include "../src/olap/simple_operations.h"
 #include "../src/olap/operations.h"
+#include "../src/olap/omp_operations.h"
+#include "../src/olap/parallel_operations.h"
+#include "../src/olap/cost_model.h"
+#include "../src/olap/reduce.h"
+#include "../src/olap/calendar_operations.h"
+#include "../src/cube/measure_cube.h"
+#include "../src/cube/partial_cube.h"
+#include "../src/builder/simple_cube_builder.h"
+#include "../src/builder/parallel_simple_cube_builder.h"
+#include "../src/builder/omp_sc_builder.h"
+#include "../src/builder/streaming_cube_builder.h"
+#include "../src/cube/time_axis.h"
+#include "../src/utils/time_utils.h"
+#include "../src/utils/thread_pool.h"
+#include "../src/loader/cube_file.h"
 
 void test_basic_indexing() {
     Datacube<int> cube(2,2,2);
@@ -74,15 +110,985 @@ void test_dice() {
     assert(sub.lat_dim()==2);
     assert(sub.lon_dim()==2);
 
+    // a view aliases the source: no copy until materialized
+    assert(sub.at(0,0,0) == cube.at(1,1,1));
+    assert(&sub.at(1,1,1) == &cube.at(2,2,2));
+
+    auto corner = olap::dice(sub, 1,2, 1,2, 0,2);
+    assert(corner.at(0,0,1) == cube.at(2,2,2));
+    assert(olap::global_mean(corner) == (cube.at(2,2,1) + cube.at(2,2,2)) / 2);
+
+    auto owned = sub.materialize<Datacube<int>>();
+    cube.at(1,1,1) = -1;
+    assert(owned.at(0,0,0) == 13);
+
     std::cout << "✓ test_dice passed\n";
 }
 
+void test_storage_layout() {
+    SimpleCube<float> cube(3, 4, 5);
+
+    // one aligned buffer, rows at explicit strides
+    assert(reinterpret_cast<std::uintptr_t>(cube.data()) % kCubeAlignment == 0);
+    assert(cube.size() == 3 * 4 * 5);
+    assert(cube.row(2, 1) == cube.data() + 2 * cube.t_stride() + 1 * cube.lat_stride());
+
+    cube.row(1, 2)[3] = 7.0f;
+    assert(cube.at(1, 2, 3) == 7.0f);
+
+    if (kCubeBoundsCheck) {
+        bool thrown = false;
+        try { cube.at(3, 0, 0); } catch (const std::out_of_range&) { thrown = true; }
+        assert(thrown);
+    }
+
+    std::cout << "✓ test_storage_layout passed\n";
+}
+
+void test_tiled_cube() {
+    SimpleCube<float> cube(5, 7, 9);
+    for (size_t t = 0; t < 5; ++t)
+        for (size_t lat = 0; lat < 7; ++lat)
+            for (size_t lon = 0; lon < 9; ++lon)
+                cube.at(t, lat, lon) = t * 100.0f + lat * 10.0f + lon;
+
+    // tiles that do not divide the cube, so edge tiles carry padding
+    auto tiled = TiledCube<float>::from_cube(cube, TileShape{2, 3, 4});
+    assert(tiled.tiles_time() == 3 && tiled.tiles_lat_dim() == 3 && tiled.tiles_lon_dim() == 3);
+    assert(tiled.at(4, 6, 8) == 468.0f);
+
+    float row[5];
+    tiled.read_row(3, 2, 2, 5, row);
+    for (size_t i = 0; i < 5; ++i)
+        assert(row[i] == cube.at(3, 2, 2 + i));
+
+    float sum = 0.0f;
+    for (size_t i = 0; i < tiled.storage_size(); ++i)
+        sum += tiled.data()[i];
+
+    float expected = 0.0f;
+    for (size_t i = 0; i < cube.size(); ++i)
+        expected += cube.data()[i];
+
+    assert(sum == expected);
+
+    std::cout << "✓ test_tiled_cube passed\n";
+}
+
+void test_pixel_major() {
+    SimpleCube<float> cube(70, 3, 5);
+    for (size_t t = 0; t < 70; ++t)
+        for (size_t lat = 0; lat < 3; ++lat)
+            for (size_t lon = 0; lon < 5; ++lon)
+                cube.at(t, lat, lon) = t + lat * 0.5f + lon * 0.25f;
+
+    // block smaller than both axes so the transpose crosses block edges
+    auto pm = PixelMajorCube<float>::from_cube(cube, 8);
+    const float* series = pm.series(2, 3);
+    for (size_t t = 0; t < 70; ++t)
+        assert(series[t] == cube.at(t, 2, 3));
+
+    auto box = pixel_olap::region_timeseries(pm, 0, 2, 1, 3);
+    assert(box == simple_olap::region_timeseries(cube, 0, 2, 1, 3));
+
+    auto rolled = pixel_olap::rollup_time_sum(pm);
+    auto expected = simple_olap::rollup_time_sum(cube);
+    for (size_t i = 0; i < rolled.size(); ++i)
+        assert(rolled.data()[i] == expected.data()[i]);
+
+    std::cout << "✓ test_pixel_major passed\n";
+}
+
+void test_sparse_cube() {
+    SimpleCube<float> cube(4, 3, 6);
+    cube.fill(0.0f);
+    cube.at(0, 0, 5) = 1.5f;
+    cube.at(1, 2, 0) = 2.0f;
+    cube.at(1, 2, 3) = -0.5f;
+    cube.at(3, 1, 2) = 4.0f;
+
+    auto sparse = SparseCube<float>::from_cube(cube);
+    assert(sparse.nnz() == 4);
+    assert(sparse.at(1, 2, 3) == -0.5f && sparse.at(1, 2, 2) == 0.0f);
+
+    auto dense = sparse.to_cube<SimpleCube<float>>();
+    for (size_t i = 0; i < cube.size(); ++i)
+        assert(dense.data()[i] == cube.data()[i]);
+
+    auto rolled = sparse_olap::rollup_time_sum(sparse);
+    auto expected = simple_olap::rollup_time_sum(cube);
+    for (size_t i = 0; i < rolled.size(); ++i)
+        assert(rolled.data()[i] == expected.data()[i]);
+
+    auto slice = sparse_olap::slice_time(sparse, 1);
+    assert(slice.time_dim() == 1 && slice.nnz() == 2 && slice.at(0, 2, 0) == 2.0f);
+
+    auto empty = sparse_olap::slice_time(SparseCube<float>(2, 0, 6), 1);
+    assert(empty.time_dim() == 1 && empty.lat_dim() == 0 && empty.nnz() == 0);
+
+    assert(sparse_olap::global_mean(sparse) == 7.0f / cube.size());
+    assert(sparse_olap::region_mean(sparse, 1, 2, 2, 3, 1, 6) == -0.5f / 5);
+
+    std::cout << "✓ test_sparse_cube passed\n";
+}
+
+void test_quantized_cube() {
+    SimpleCube<float> cube(5, 2, 9);
+    for (size_t i = 0; i < cube.size(); ++i)
+        cube.data()[i] = (i % 3 == 0) ? 0.0f : i * 0.25f;
+
+    // fp16 holds quarter steps below 2048 exactly
+    auto h = QuantizedCube::from_cube(cube, QuantFormat::Half);
+    assert(h.bytes() == cube.size() * 2);
+    assert(h.at(4, 1, 8) == cube.at(4, 1, 8));
+
+    auto rolled = quant_olap::rollup_time_sum(h);
+    auto expected = simple_olap::rollup_time_sum(cube);
+    for (size_t i = 0; i < rolled.size(); ++i)
+        assert(rolled.data()[i] == expected.data()[i]);
+
+    // int16: zero stays exact, every cell within half a step
+    auto q = QuantizedCube::from_cube(cube, QuantFormat::ScaledInt16);
+    assert(q.at(0, 0, 0) == 0.0f);
+    for (size_t t = 0; t < 5; ++t)
+        for (size_t lat = 0; lat < 2; ++lat)
+            for (size_t lon = 0; lon < 9; ++lon)
+                assert(std::fabs(q.at(t, lat, lon) - cube.at(t, lat, lon)) <= q.scale() * 0.5f);
+
+    float exact = simple_olap::global_mean(cube);
+    assert(std::fabs(quant_olap::global_mean(q) - exact) <= q.scale());
+    assert(std::fabs(quant_olap::global_mean(h) - exact) <= 1e-4f * exact);
+
+    auto slice = quant_olap::slice_time(q, 3);
+    assert(slice.at(0, 1, 2) == q.at(3, 1, 2));
+
+    bool threw = false;
+    try { quant_olap::slice_time(q, q.time_dim()); }
+    catch (const std::out_of_range&) { threw = true; }
+    assert(threw);
+
+    std::cout << "✓ test_quantized_cube passed\n";
+}
+
+void test_validity_mask() {
+    // 70 lon cells: rows span two mask words, the second partly padding
+    SimpleCube<float> cube(2, 2, 70);
+    SimpleCube<int> count(2, 2, 70);
+    cube.fill(0.0f);
+    count.fill(0);
+
+    count.at(0, 0, 3) = 1;                          // observed zero rain
+    count.at(0, 1, 64) = 2; cube.at(0, 1, 64) = 4.0f;
+    count.at(1, 1, 69) = 1; cube.at(1, 1, 69) = 2.0f;
+    for (size_t lon = 0; lon < 64; ++lon) {         // one full word
+        count.at(1, 0, lon) = 1;
+        cube.at(1, 0, lon) = 1.0f;
+    }
+
+    auto valid = ValidityMask::from_counts(count);
+    assert(valid.words_per_row() == 2 && valid.count() == 67);
+    assert(valid.test(0, 0, 3) && !valid.test(0, 0, 4));
+
+    // 64 + 4 + 2 over 67 observed cells; empty cells are not averaged in
+    assert(omp_olap::global_mean(cube, valid) == 70.0f / 67);
+    assert(omp_olap::region_mean(cube, valid, 0, 2, 1, 2, 60, 70) == 3.0f);
+    assert(omp_olap::region_mean(cube, valid, 0, 1, 0, 1, 4, 70) == 0.0f);
+
+    auto borrowed = ValidityMask::borrow(valid.data(), 2, 2, 70);
+    ValidityMask copy = borrowed;
+    assert(copy.is_borrowed() && copy.data() == valid.data());
+
+    std::cout << "✓ test_validity_mask passed\n";
+}
+
+void test_prefix_sum_index() {
+    SimpleCube<float> cube(4, 3, 5);
+    SimpleCube<int> count(4, 3, 5);
+    for (size_t i = 0; i < cube.size(); ++i) {
+        cube.data()[i] = (i % 4 == 0) ? 0.0f : i * 0.5f;
+        count.data()[i] = (i % 4 == 0) ? 0 : 1;
+    }
+    auto valid = ValidityMask::from_counts(count);
+
+    auto index = PrefixSumIndex::build(cube);
+    auto masked = PrefixSumIndex::build(cube, &valid);
+    assert(masked.has_count() && !index.has_count());
+
+    // every box against a direct scan
+    for (size_t t0 = 0; t0 < 4; ++t0) for (size_t t1 = t0 + 1; t1 <= 4; ++t1)
+    for (size_t a0 = 0; a0 < 3; ++a0) for (size_t a1 = a0 + 1; a1 <= 3; ++a1)
+    for (size_t o0 = 0; o0 < 5; ++o0) for (size_t o1 = o0 + 1; o1 <= 5; ++o1) {
+        double sum = 0;
+        size_t observed = 0;
+        for (size_t t = t0; t < t1; ++t)
+            for (size_t a = a0; a < a1; ++a)
+                for (size_t o = o0; o < o1; ++o) {
+                    sum += cube.at(t, a, o);
+                    observed += count.at(t, a, o);
+                }
+
+        CubeBox box{t0, t1, a0, a1, o0, o1};
+        assert(index.box_sum(box) == sum);
+        assert(index.box_count(box) == box.volume());
+        assert(masked.box_count(box) == observed);
+        assert(masked.box_mean(box) == (observed ? sum / observed : 0.0));
+    }
+
+    bool thrown = false;
+    try { index.box_sum({0, 5, 0, 1, 0, 1}); } catch (const std::out_of_range&) { thrown = true; }
+    assert(thrown);
+
+    std::cout << "✓ test_prefix_sum_index passed\n";
+}
+
+void test_thread_pool() {
+    ThreadPool pool(4);
+    assert(pool.size() == 4);
+
+    // every index exactly once
+    std::vector<int> hits(1000, 0);
+    pool.parallel_for(hits.size(), [&](size_t i) { hits[i] += 1; });
+    for (int h : hits) assert(h == 1);
+
+    // ranges tile [3, 103) in order
+    std::vector<size_t> seen(100, 0);
+    pool.parallel_for_range(3, 103, [&](size_t part, size_t lo, size_t hi) {
+        assert(part < 7 && lo < hi);
+        for (size_t i = lo; i < hi; ++i) seen[i - 3] += 1;
+    }, 7);
+    for (size_t s : seen) assert(s == 1);
+
+    // nested fork/join from a pool thread cannot deadlock
+    std::atomic<int> inner{0};
+    pool.parallel_for(8, [&](size_t) {
+        pool.parallel_for(8, [&](size_t) { inner.fetch_add(1); });
+    });
+    assert(inner.load() == 64);
+
+    assert(pool.submit([] { return 42; }).get() == 42);
+
+    bool thrown = false;
+    try {
+        pool.parallel_for(16, [](size_t i) {
+            if (i == 5) throw std::runtime_error("task failed");
+        });
+    } catch (const std::runtime_error&) { thrown = true; }
+    assert(thrown);
+
+    // parallel_olap on the shared pool matches omp_olap
+    SimpleCube<float> cube(6, 5, 3);
+    for (size_t i = 0; i < cube.size(); ++i) cube.data()[i] = i * 0.25f;
+    auto a = parallel_olap::rollup_time_sum(cube, 3);
+    auto b = omp_olap::rollup_time_sum(cube);
+    for (size_t i = 0; i < a.size(); ++i) assert(a.data()[i] == b.data()[i]);
+    assert(std::fabs(parallel_olap::global_mean(cube, 4) - omp_olap::global_mean(cube)) < 1e-4f);
+
+    std::cout << "✓ test_thread_pool passed\n";
+}
+
+void test_time_reduction() {
+    // bands tile every lat row and split evenly across workers
+    auto bands = time_reduction::plan<float>(140, 140, 4);
+    assert(bands.count % 4 == 0 && bands.rows * 140 * sizeof(float) <= time_reduction::kBandBytes);
+    assert(bands.begin(0) == 0 && bands.end(bands.count - 1) == 140);
+
+    SimpleCube<float> cube(7, 9, 70);
+    SimpleCube<int> count(7, 9, 70);
+    for (size_t i = 0; i < cube.size(); ++i) {
+        cube.data()[i] = (i % 5 == 0) ? 0.0f : (i % 23) * 0.37f;
+        count.data()[i] = (i % 5 == 0) ? 0 : 1;
+    }
+    auto valid = ValidityMask::from_counts(count);
+
+    // all backends agree bit for bit on rollups, on cubes and on strided views
+    for (const CubeView<float>& v : {CubeView<float>(cube), CubeView<float>(cube).sub(1, 6, 2, 8, 3, 67)}) {
+        SimpleCube<float> ref(1, v.lat_dim(), v.lon_dim());
+        for (size_t t = 0; t < v.time_dim(); ++t)
+            for (size_t a = 0; a < v.lat_dim(); ++a)
+                for (size_t o = 0; o < v.lon_dim(); ++o)
+                    ref.at(0, a, o) += v.at(t, a, o);
+
+        auto s1 = simple_olap::rollup_time_sum(v);
+        auto s2 = parallel_olap::rollup_time_sum(v, 3);
+        auto s3 = omp_olap::rollup_time_sum(v);
+        auto s4 = olap::rollup_time_sum(v);
+        auto m1 = simple_olap::rollup_time_mean(v);
+        auto m2 = parallel_olap::rollup_time_mean(v, 2);
+        auto m3 = omp_olap::rollup_time_mean(v);
+        for (size_t i = 0; i < ref.size(); ++i) {
+            assert(s1.data()[i] == ref.data()[i] && s2.data()[i] == ref.data()[i]);
+            assert(s3.data()[i] == ref.data()[i] && s4.data()[i] == ref.data()[i]);
+            assert(m1.data()[i] == m2.data()[i] && m2.data()[i] == m3.data()[i]);
+        }
+
+        float g = simple_olap::region_mean(v, 0, v.time_dim(), 0, v.lat_dim(), 0, v.lon_dim());
+        assert(std::fabs(simple_olap::global_mean(v) - g) < 1e-4f);
+        assert(std::fabs(parallel_olap::global_mean(v, 3) - g) < 1e-4f);
+        assert(std::fabs(omp_olap::global_mean(v) - g) < 1e-4f);
+        assert(std::fabs(olap::global_mean(v) - g) < 1e-4f);
+    }
+
+    // observed hours and the per-pixel observed mean
+    auto hours = omp_olap::rollup_time_count(valid);
+    auto observed = omp_olap::rollup_time_mean(cube, valid);
+    for (size_t a = 0; a < 9; ++a)
+        for (size_t o = 0; o < 70; ++o) {
+            int n = 0;
+            float sum = 0;
+            for (size_t t = 0; t < 7; ++t) {
+                n += count.at(t, a, o);
+                sum += cube.at(t, a, o);
+            }
+            assert(hours.at(0, a, o) == n);
+            assert(observed.at(0, a, o) == (n ? sum / n : 0.0f));
+        }
+
+    std::cout << "✓ test_time_reduction passed\n";
+}
+
+void test_reduce() {
+    using namespace reduce_olap;
+
+    SimpleCube<float> cube(6, 5, 7);
+    for (size_t i = 0; i < cube.size(); ++i)
+        cube.data()[i] = (i % 4 == 0) ? 0.0f : static_cast<float>((i * 37) % 11) - 3.0f;
+
+    // every subset of axes against a brute-force pass per output
+    for (unsigned axes = 0; axes <= axis::all; ++axes) {
+        auto [sum, mean, mn, mx, arg, sd, wet] =
+            reduce(cube, axes, Sum{}, Mean{}, Min{}, Max{}, ArgMax{}, Std{}, Count{0.0});
+
+        const bool rt = axes & axis::t, ra = axes & axis::lat, ro = axes & axis::lon;
+        assert(sum.time_dim() == (rt ? 1 : 6) && sum.lat_dim() == (ra ? 1 : 5) &&
+               sum.lon_dim() == (ro ? 1 : 7));
+
+        for (size_t T = 0; T < sum.time_dim(); ++T)
+        for (size_t A = 0; A < sum.lat_dim(); ++A)
+        for (size_t O = 0; O < sum.lon_dim(); ++O) {
+            double s = 0, s2 = 0, best = -1e30, low = 1e30;
+            long n = 0, n_wet = 0, pos = 0, best_pos = -1;
+
+            for (size_t t = rt ? 0 : T; t < (rt ? 6 : T + 1); ++t)
+            for (size_t a = ra ? 0 : A; a < (ra ? 5 : A + 1); ++a)
+            for (size_t o = ro ? 0 : O; o < (ro ? 7 : O + 1); ++o, ++pos) {
+                double v = cube.at(t, a, o);
+                s += v; s2 += v * v; ++n;
+                n_wet += v > 0;
+                low = std::min(low, v);
+                if (v > best) { best = v; best_pos = pos; }
+            }
+
+            double m = s / n;
+            assert(std::fabs(sum.at(T, A, O) - s) < 1e-3);
+            assert(std::fabs(mean.at(T, A, O) - m) < 1e-4);
+            assert(mn.at(T, A, O) == low && mx.at(T, A, O) == best);
+            assert(arg.at(T, A, O) == best_pos);
+            assert(std::fabs(sd.at(T, A, O) - std::sqrt(std::max(0.0, s2 / n - m * m))) < 1e-4);
+            assert(wet.at(T, A, O) == n_wet);
+        }
+    }
+
+    // NaN is skipped by ArgMax in both the lane and the row kernels
+    SimpleCube<float> gaps(2, 1, 16);
+    for (size_t i = 0; i < gaps.size(); ++i)
+        gaps.data()[i] = static_cast<float>(i % 5);
+    gaps.at(0, 0, 0) = std::numeric_limits<float>::quiet_NaN();
+    gaps.at(1, 0, 0) = std::numeric_limits<float>::quiet_NaN();
+    gaps.at(1, 0, 4) = std::numeric_limits<float>::quiet_NaN();
+    for (size_t lon = 1; lon < 16; ++lon) gaps.at(1, 0, lon) = -1.0f;
+
+    auto [along_lon] = reduce(gaps, axis::lon, ArgMax{});
+    assert(along_lon.at(0, 0, 0) == 4 && along_lon.at(1, 0, 0) == 1);
+    auto [along_t] = reduce(gaps, axis::t, ArgMax{});
+    assert(along_t.at(0, 0, 0) == -1 && along_t.at(0, 0, 4) == 0 && along_t.at(0, 0, 1) == 0);
+
+    // time rollups agree with the dedicated kernels
+    auto [rolled] = reduce(cube, axis::t, Sum{});
+    auto ref = simple_olap::rollup_time_sum(cube);
+    for (size_t i = 0; i < ref.size(); ++i) assert(rolled.data()[i] == ref.data()[i]);
+
+    std::cout << "✓ test_reduce passed\n";
+}
+
+void test_calendar_rollups() {
+    using namespace calendar_olap;
+
+    // 2024-05-31T22 .. 2024-06-02T01 with a gap, compacted to 12 hours
+    const int32_t start = timeutil::parse_epoch_hour("2024-05-31T22");
+    std::vector<int32_t> hours;
+    for (int32_t h = 0; h < 28; ++h)
+        if (h < 6 || h > 21)
+            hours.push_back(start + h);
+    TimeAxis axis = TimeAxis::from_sorted_hours(hours);
+    assert(axis.size() == 12);
+
+    auto days = group_by(axis, Period::Day);
+    assert(days.size() == 3);
+    assert(days.labels[0] == "2024-05-31" && days.labels[2] == "2024-06-02");
+    assert(days.hours[0] == 2 && days.hours[1] == 8 && days.hours[2] == 2);
+
+    auto months = group_by(axis, Period::Month);
+    assert(months.size() == 2 && months.labels[1] == "2024-06");
+    assert(group_by(axis, Period::Season).labels ==
+           (std::vector<std::string>{"MAM", "JJA"}));
+
+    auto diurnal = group_by(axis, Period::HourOfDay);
+    assert(diurnal.size() == 8 && diurnal.labels[0] == "00" && diurnal.labels[7] == "23");
+    assert(diurnal.hours[0] == 2 && diurnal.hours[2] == 1);
+
+    SimpleCube<float> cube(12, 3, 5);
+    SimpleCube<int> counts(12, 3, 5);
+    for (size_t i = 0; i < cube.size(); ++i) {
+        counts.data()[i] = static_cast<int>(i % 3);
+        cube.data()[i] = counts.data()[i] ? static_cast<float>(i % 7) : 0.0f;
+    }
+    auto valid = ValidityMask::from_counts(counts);
+
+    auto total = rollup_sum(cube, days);
+    auto mean = rollup_mean(cube, days);
+    SimpleCube<int32_t> n(0, 0, 0), obs(0, 0, 0);
+    auto weighted = rollup_mean(cube, days, counts, &n);
+    auto observed = rollup_mean(cube, days, valid, &obs);
+    assert(total.time_dim() == 3 && n.time_dim() == 3);
+
+    for (size_t g = 0; g < 3; ++g)
+        for (size_t lat = 0; lat < 3; ++lat)
+            for (size_t lon = 0; lon < 5; ++lon) {
+                double s = 0, sw = 0;
+                int c = 0, seen = 0;
+                for (size_t t = 0; t < 12; ++t)
+                    if (days.group[t] == static_cast<int32_t>(g)) {
+                        s += cube.at(t, lat, lon);
+                        sw += cube.at(t, lat, lon) * counts.at(t, lat, lon);
+                        c += counts.at(t, lat, lon);
+                        seen += counts.at(t, lat, lon) > 0;
+                    }
+                assert(std::fabs(total.at(g, lat, lon) - s) < 1e-4);
+                assert(std::fabs(mean.at(g, lat, lon) - s / days.hours[g]) < 1e-4);
+                assert(n.at(g, lat, lon) == c && obs.at(g, lat, lon) == seen);
+                assert(std::fabs(weighted.at(g, lat, lon) - (c ? sw / c : 0.0)) < 1e-4);
+                assert(std::fabs(observed.at(g, lat, lon) - (seen ? s / seen : 0.0)) < 1e-4);
+            }
+
+    bool threw = false;
+    try { rollup_sum(CubeView<float>(cube).sub(0, 6, 0, 3, 0, 5), days); }
+    catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+
+    std::cout << "✓ test_calendar_rollups passed\n";
+}
+
+void test_measure_cube() {
+    // Scatter observations the way the builders do: measures see each
+    // value with the cell's sum and count before it
+    SimpleCube<float> sum(2, 3, 4);
+    SimpleCube<int> count(2, 3, 4);
+    MeasureCube measures(measure::min | measure::max | measure::m2);
+    assert(measures.has(measure::count) && !measures.has(measure::sum));
+    measures.reset(2, 3, 4);
+
+    std::vector<std::vector<float>> seen(sum.size());
+    for (int k = 0; k < 200; ++k) {
+        size_t c = static_cast<size_t>(k * 7) % (sum.size() - 3);    // last 3 cells empty
+        float v = static_cast<float>((k * 31) % 17) * 0.5f - 2.0f;
+        measures.add(c, v, sum.data()[c], count.data()[c]);
+        sum.data()[c] += v;
+        count.data()[c] += 1;
+        seen[c].push_back(v);
+    }
+    for (size_t i = 0; i < sum.size(); ++i)
+        measures.finish(i, sum.data()[i], count.data()[i]);
+
+    auto var = measures.variance();
+    auto sample = measures.variance(true);
+    auto sd = measures.std_dev();
+
+    for (size_t i = 0; i < sum.size(); ++i) {
+        const auto& v = seen[i];
+        assert(measures.count.data()[i] == static_cast<int>(v.size()));
+
+        if (v.empty()) {
+            assert(measures.min.data()[i] == 0.0f && measures.max.data()[i] == 0.0f);
+            assert(var.data()[i] == 0.0f);
+            continue;
+        }
+
+        double mean = 0, ss = 0;
+        for (float x : v) mean += x;
+        mean /= v.size();
+        for (float x : v) ss += (x - mean) * (x - mean);
+
+        assert(measures.min.data()[i] == *std::min_element(v.begin(), v.end()));
+        assert(measures.max.data()[i] == *std::max_element(v.begin(), v.end()));
+        assert(std::fabs(measures.m2.data()[i] - ss) < 1e-3 * (1 + ss));
+        assert(std::fabs(var.data()[i] - ss / v.size()) < 1e-3);
+        assert(std::fabs(sd.data()[i] - std::sqrt(ss / v.size())) < 1e-3);
+        if (v.size() > 1)
+            assert(std::fabs(sample.data()[i] - ss / (v.size() - 1)) < 1e-3);
+    }
+
+    bool threw = false;
+    try { MeasureCube(measure::max).variance(); }
+    catch (const std::logic_error&) { threw = true; }
+    assert(threw);
+
+    std::cout << "✓ test_measure_cube passed\n";
+}
+
+void test_cost_model() {
+    // uncalibrated: always sequential
+    CostModel none;
+    assert(none.choose(OlapOp::GlobalMean, 1000000).best.backend == Backend::Sequential);
+
+    CostModel model;
+    model.set_width(8);
+    for (OlapOp op : {OlapOp::GlobalMean, OlapOp::RollupTimeSum}) {
+        model.set(op, Backend::Sequential, {1e-7, 1e-9});
+        model.set(op, Backend::Threads,    {2e-5, 2e-10});
+        model.set(op, Backend::OpenMP,     {5e-6, 2e-10});
+    }
+
+    auto tiny = model.choose(OlapOp::RegionMean, 256);
+    assert(tiny.best.backend == Backend::Sequential && tiny.best.threads == 1);
+
+    // 5e-6 s overhead buys 5000 sequential cells per thread
+    auto mid = model.choose(OlapOp::GlobalMean, 20000);
+    assert(mid.best.backend == Backend::OpenMP && mid.best.threads == 4);
+    // at half width the per-cell term doubles
+    assert(std::fabs(mid.best.seconds - (5e-6 + 2e-10 * 20000 * 2)) < 1e-12);
+
+    auto big = model.choose(OlapOp::RollupTimeMean, 10000000);
+    assert(big.best.backend == Backend::OpenMP && big.best.threads == 8);
+    assert(big.candidates[1].backend == Backend::Threads);
+
+    // every backend computes the same aggregates
+    SimpleCube<float> cube(5, 4, 6);
+    for (size_t i = 0; i < cube.size(); ++i) cube.data()[i] = (i % 9) * 0.5f;
+    CubeBox box{1, 4, 0, 3, 2, 6};
+    float ref = simple_olap::region_mean(cube, 1, 4, 0, 3, 2, 6);
+    auto ref_mean = simple_olap::rollup_time_mean(cube);
+
+    for (Backend b : {Backend::Sequential, Backend::Threads, Backend::OpenMP}) {
+        BackendEstimate on{b, 3, 0.0};
+        assert(std::fabs(backend_olap::region_mean(cube, box, on) - ref) < 1e-5f);
+        auto mean = backend_olap::rollup_time_mean(cube, on);
+        for (size_t i = 0; i < mean.size(); ++i)
+            assert(std::fabs(mean.data()[i] - ref_mean.data()[i]) < 1e-5f);
+    }
+
+    std::cout << "✓ test_cost_model passed\n";
+}
+
+void test_partial_cube() {
+    struct Obs { int32_t hour; size_t cell; float v; };
+    std::vector<Obs> obs;
+    for (int k = 0; k < 300; ++k)
+        obs.push_back({477000 + (k * 5) % 9, static_cast<size_t>(k * 11) % 12,
+                       static_cast<float>((k * 13) % 19) * 0.25f});
+
+    // Shard of the observations with hour in [lo, hi), binned as a builder
+    // would onto its own compact axis
+    auto shard = [&](int32_t lo, int32_t hi) {
+        std::vector<int32_t> hours;
+        for (const auto& o : obs)
+            if (o.hour >= lo && o.hour < hi) hours.push_back(o.hour);
+        TimeAxis axis = TimeAxis::from_hours(hours);
+
+        MeasureCube m(measure::all);
+        m.reset(axis.size(), 3, 4);
+        SimpleCube<float> sum(axis.size(), 3, 4);
+        SimpleCube<int> count(axis.size(), 3, 4);
+        for (const auto& o : obs) {
+            if (o.hour < lo || o.hour >= hi) continue;
+            size_t c = axis.index(o.hour) * 12 + o.cell;
+            m.add(c, o.v, sum.data()[c], count.data()[c]);
+            sum.data()[c] += o.v;
+            count.data()[c] += 1;
+        }
+        for (size_t c = 0; c < sum.size(); ++c)
+            m.finish(c, sum.data()[c], count.data()[c]);
+        return PartialCube(axis, std::move(m));
+    };
+
+    PartialCube whole = shard(477000, 477009);
+    PartialCube a = shard(477000, 477003), b = shard(477003, 477006), c = shard(477006, 477009);
+    assert(whole.time_dim() == 9 && a.time_dim() == 3);
+
+    PartialCube left = PartialCube::merge(PartialCube::merge(a, b), c);
+    PartialCube right = PartialCube::merge(c, PartialCube::merge(b, a));
+    assert(left.axis() == whole.axis() && right.axis() == whole.axis());
+
+    auto close = [](float x, float y) { return std::fabs(x - y) < 1e-3f * (1 + std::fabs(y)); };
+    const auto& w = whole.measures();
+    for (const PartialCube* p : {&left, &right}) {
+        const auto& m = p->measures();
+        for (size_t i = 0; i < m.sum.size(); ++i) {
+            assert(m.count.data()[i] == w.count.data()[i]);
+            assert(close(m.sum.data()[i], w.sum.data()[i]));
+            assert(m.min.data()[i] == w.min.data()[i] && m.max.data()[i] == w.max.data()[i]);
+            assert(close(m.m2.data()[i], w.m2.data()[i]));
+        }
+    }
+
+    // Overlapping hours combine cell by cell; shards keep common measures
+    MeasureCube sums_only(PartialCube::kRequired);
+    sums_only.reset(a.time_dim(), 3, 4);
+    sums_only.sum = a.measures().sum;
+    sums_only.count = a.measures().count;
+    PartialCube doubled = PartialCube::merge(a, PartialCube(a.axis(), std::move(sums_only)));
+    assert(doubled.time_dim() == 3 && !doubled.has(measure::max));
+    assert(doubled.measures().count.data()[5] == 2 * a.measures().count.data()[5]);
+
+    ValidityMask valid;
+    auto mean = left.finalize(&valid);
+    for (size_t i = 0; i < mean.size(); ++i) {
+        int n = w.count.data()[i];
+        assert(close(mean.data()[i], n ? w.sum.data()[i] / n : 0.0f));
+    }
+    assert(valid.count() == ValidityMask::from_counts(w.count).count());
+
+    // Round trip through the cube file format
+    const std::string path = "test_partial_cube.gpmcube";
+    CubeFile::write(path, left);
+    {
+        MappedCube mapped(path);
+        assert(mapped.holds_sums() && mapped.has_count());
+        PartialCube loaded = mapped.partial();
+        assert(loaded.axis() == left.axis() && loaded.has(measure::all));
+        const auto& m = loaded.measures();
+        for (size_t i = 0; i < m.sum.size(); ++i)
+            assert(m.sum.data()[i] == left.measures().sum.data()[i] &&
+                   m.m2.data()[i] == left.measures().m2.data()[i]);
+    }
+    std::remove(path.c_str());
+
+    MeasureCube other_grid(PartialCube::kRequired);
+    other_grid.reset(3, 2, 4);
+    bool threw = false;
+    try { PartialCube::merge(a, PartialCube(a.axis(), std::move(other_grid))); }
+    catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+
+    std::cout << "✓ test_partial_cube passed\n";
+}
+
+void test_cube_file() {
+    SimpleCube<float> cube(3, 4, 5);
+    SimpleCube<int> count(3, 4, 5);
+    for (size_t i = 0; i < cube.size(); ++i) {
+        cube.data()[i] = i * 0.5f;
+        count.data()[i] = static_cast<int>(i % 7);
+    }
+
+    TimeAxis axis = TimeAxis::from_sorted_hours({477003, 477005, 477010});
+    const std::string path = "test_cube_file.gpmcube";
+    auto valid = ValidityMask::from_counts(count);
+    CubeFile::write(path, cube, axis, GridSpec(), &count, &valid);
+
+    {
+        MappedCube mapped(path);
+        auto view = mapped.cube();
+
+        assert(view.time_dim() == 3 && view.lat_dim() == 4 && view.lon_dim() == 5);
+        assert(view.at(2, 3, 4) == cube.at(2, 3, 4));
+        assert(mapped.has_count() && mapped.count().at(1, 2, 3) == count.at(1, 2, 3));
+        assert(mapped.axis() == axis && mapped.axis().compact());
+        assert(mapped.grid().lat_bins() == GridSpec().lat_bins());
+        assert(mapped.header().data_offset % CubeFile::kAlignment == 0);
+        assert(mapped.has_validity() && mapped.validity().count() == valid.count());
+        assert(mapped.validity().test(0, 0, 1) && !mapped.validity().test(1, 0, 1));
+    }
+
+    // Corrupt headers and time axes are rejected, not mapped
+    const CubeFileHeader good = MappedCube(path).header();
+
+    auto rejects = [&](auto&& corrupt) {
+        CubeFile::write(path, cube, axis, GridSpec(), &count, &valid);
+        {
+            std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+            corrupt(f);
+        }
+        try { MappedCube mapped(path); }
+        catch (const std::runtime_error&) { return true; }
+        return false;
+    };
+    auto put = [](std::fstream& f, uint64_t offset, const auto& value) {
+        f.seekp(static_cast<std::streamoff>(offset));
+        f.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+
+    // 3 × 2^62 × 5 wraps to the real cell count × 2^62 mod 2^64
+    assert(rejects([&](std::fstream& f) {
+        put(f, offsetof(CubeFileHeader, lat_dim), uint64_t(1) << 62);
+    }));
+    assert(rejects([&](std::fstream& f) {
+        put(f, good.hours_offset, int32_t(477010));           // descending
+    }));
+    assert(rejects([&](std::fstream& f) {
+        put(f, good.hours_offset + 4, int32_t(477003));       // repeated
+    }));
+    assert(rejects([&](std::fstream& f) {
+        put(f, offsetof(CubeFileHeader, flags), good.flags & ~cube_flags::COMPACT_AXIS);
+    }));
+    assert(!rejects([](std::fstream&) {}));
+
+    std::remove(path.c_str());
+
+    std::cout << "✓ test_cube_file passed\n";
+}
+
+void test_epoch_hours() {
+    int32_t h = timeutil::parse_epoch_hour("2024-06-01T03:15:22.000000000");
+
+    assert(h == 477003);
+    assert(timeutil::format_hour(h) == "2024-06-01T03");
+    assert(timeutil::parse_epoch_hour("1970-01-01T00") == 0);
+    assert(timeutil::parse_epoch_hour(std::string(29, '\0')) == timeutil::kInvalidHour);
+
+    std::cout << "✓ test_epoch_hours passed\n";
+}
+
+void test_time_axis() {
+    int32_t h0 = timeutil::parse_epoch_hour("2024-06-01T00");
+    std::vector<int32_t> hours = {h0 + 5, h0, timeutil::kInvalidHour, h0 + 2, h0 + 5};
+
+    TimeAxis dense = TimeAxis::from_hours(hours, false);
+    assert(dense.size() == 6);
+    assert(dense.index(h0 + 2) == 2);
+
+    TimeAxis axis = TimeAxis::from_hours(hours);
+    assert(axis.size() == 3);
+    assert(axis.index(h0) == 0);
+    assert(axis.index(h0 + 2) == 1);
+    assert(axis.index(h0 + 5) == 2);
+    assert(axis.index(h0 + 1) == -1);
+    assert(axis.datetime(2) == "2024-06-01T05");
+    assert(axis.index_of("2024-06-01T02") == 1);
+    assert(axis.range(h0 + 1, h0 + 6) == std::make_pair(size_t(1), size_t(3)));
+
+    std::cout << "✓ test_time_axis passed\n";
+}
+
+// Observations over a handful of hours with gaps between them, plus the
+// cases every builder must skip: fill values, points off the grid and
+// undecodable timestamps
+struct Observations {
+    std::vector<float> lat, lon, nsr;
+    std::vector<int32_t> hours;
+};
+
+Observations synthetic_observations(size_t n = 6000)
+{
+    const int32_t start = timeutil::parse_epoch_hour("2024-06-01T00");
+    const int32_t offsets[] = {0, 1, 2, 5, 6, 11, 12, 13, 20, 27};
+
+    Observations obs;
+    uint32_t state = 12345;
+    auto next = [&] { state = state * 1664525u + 1013904223u; return state >> 8; };
+
+    for (size_t i = 0; i < n; ++i) {
+        obs.hours.push_back(i % 97 == 0 ? timeutil::kInvalidHour
+                                        : start + offsets[(i * 10) / n]);
+        obs.lat.push_back(4.0f + static_cast<float>(next() % 37000) * 0.001f);
+        obs.lon.push_back(64.0f + static_cast<float>(next() % 37000) * 0.001f);
+        // a few hundred distinct cells, so most cells get several values
+        if (i % 3 == 0) {
+            obs.lat.back() = 20.0f + static_cast<float>(next() % 16) * 0.25f;
+            obs.lon.back() = 80.0f + static_cast<float>(next() % 16) * 0.25f;
+        }
+        obs.nsr.push_back(i % 53 == 0 ? -9999.9f : static_cast<float>(next() % 200) * 0.1f);
+    }
+    return obs;
+}
+
+// Same cells observed and the same means up to summation order
+template<typename A, typename B>
+bool same_cube(const A& a, const B& b)
+{
+    if (a.time_dim() != b.time_dim() || a.lat_dim() != b.lat_dim() || a.lon_dim() != b.lon_dim())
+        return false;
+    for (size_t t = 0; t < a.time_dim(); ++t)
+        for (size_t lat = 0; lat < a.lat_dim(); ++lat)
+            for (size_t lon = 0; lon < a.lon_dim(); ++lon) {
+                const float x = a.at(t, lat, lon), y = b.at(t, lat, lon);
+                if (std::fabs(x - y) > 1e-4f * (1.0f + std::fabs(y)))
+                    return false;
+            }
+    return true;
+}
+
+void test_parallel_builder_modes() {
+    using Mode = ParallelSimpleCubeBuilder::Accumulation;
+
+    const Observations obs = synthetic_observations();
+    const TimeAxis axis = TimeAxis::from_hours(obs.hours);
+    assert(axis.size() == 10);
+
+    ValidityMask ref_valid;
+    auto ref = SimpleCubeBuilder::build(obs.lat, obs.lon, obs.nsr, obs.hours, axis, &ref_valid);
+    assert(ref_valid.count() > 0);
+
+    for (Mode mode : {Mode::Mutex, Mode::Atomic, Mode::Privatized})
+        for (unsigned int threads : {1u, 3u, 4u}) {
+            ValidityMask valid;
+            auto cube = ParallelSimpleCubeBuilder::build(
+                obs.lat, obs.lon, obs.nsr, obs.hours, axis, threads, mode, &valid);
+            assert(same_cube(cube, ref));
+            assert(valid.count() == ref_valid.count());
+        }
+
+    std::cout << "✓ test_parallel_builder_modes passed\n";
+}
+
+void test_omp_builder_partitioning() {
+    const Observations obs = synthetic_observations();
+    const TimeAxis axis = TimeAxis::from_hours(obs.hours);
+    auto ref = SimpleCubeBuilder::build(obs.lat, obs.lon, obs.nsr, obs.hours, axis);
+
+    // A contiguous axis leaves empty time buckets between the observed
+    // hours; 16 threads is more workers than buckets with observations
+    const TimeAxis span(axis.min_hour(), axis.max_hour() - axis.min_hour() + 1);
+    auto ref_span = SimpleCubeBuilder::build(obs.lat, obs.lon, obs.nsr, obs.hours, span);
+
+    for (unsigned int threads : {1u, 2u, 3u, 16u}) {
+        SimpleCube<int> counts(0, 0, 0);
+        auto cube = OMPSimpleCubeBuilder::build(obs.lat, obs.lon, obs.nsr, obs.hours,
+                                                axis, threads, &counts);
+        assert(same_cube(cube, ref));
+
+        auto gaps = OMPSimpleCubeBuilder::build(obs.lat, obs.lon, obs.nsr, obs.hours,
+                                                span, threads);
+        assert(gaps.time_dim() == 28 && same_cube(gaps, ref_span));
+
+        // build_sparse writes the CSR rows itself; it must store exactly
+        // what compressing the dense build stores
+        for (const auto* dense : {&cube, &gaps}) {
+            const TimeAxis& on = dense == &cube ? axis : span;
+            auto sparse = OMPSimpleCubeBuilder::build_sparse(obs.lat, obs.lon, obs.nsr,
+                                                             obs.hours, on, threads);
+            auto expect = SparseCube<float>::from_cube(*dense);
+            assert(sparse.time_dim() == expect.time_dim() && sparse.nnz() == expect.nnz());
+            for (size_t t = 0; t < expect.time_dim(); ++t)
+                for (size_t lat = 0; lat < expect.lat_dim(); ++lat) {
+                    assert(sparse.row_begin(t, lat) == expect.row_begin(t, lat) &&
+                           sparse.row_end(t, lat) == expect.row_end(t, lat));
+                    for (size_t lon = 0; lon < expect.lon_dim(); ++lon)
+                        assert(sparse.at(t, lat, lon) == expect.at(t, lat, lon));
+                }
+        }
+
+        // every valid observation lands in exactly one bucket
+        long binned = 0;
+        for (size_t i = 0; i < counts.size(); ++i)
+            binned += counts.data()[i];
+        long expected = 0;
+        GridSpec grid;
+        for (size_t i = 0; i < obs.nsr.size(); ++i) {
+            size_t la, lo;
+            expected += axis.index(obs.hours[i]) >= 0 && obs.nsr[i] > -9000 &&
+                        grid.bin(obs.lat[i], obs.lon[i], la, lo);
+        }
+        assert(binned == expected);
+    }
+
+    std::cout << "✓ test_omp_builder_partitioning passed\n";
+}
+
+// Writes one zlib-compressed zarr v2 array of n elements of elem bytes,
+// leaving out chunk skip; the last chunk is padded to full size
+void write_zarr_array(const std::string& dir, const std::string& dtype, size_t elem,
+                      const std::vector<char>& raw, size_t n, size_t chunk, size_t skip)
+{
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir + "/.zarray")
+        << "{\"shape\": [" << n << "], \"chunks\": [" << chunk << "], \"dtype\": \"" << dtype
+        << "\", \"compressor\": {\"id\": \"zlib\", \"level\": 1}, \"fill_value\": null,"
+        << " \"order\": \"C\", \"zarr_format\": 2, \"filters\": null}";
+
+    for (size_t c = 0; c * chunk < n; ++c) {
+        if (c == skip) continue;
+        std::vector<char> block(chunk * elem, 0);
+        const size_t bytes = std::min(chunk, n - c * chunk) * elem;
+        std::copy_n(raw.data() + c * chunk * elem, bytes, block.data());
+
+        uLongf len = compressBound(block.size());
+        std::vector<Bytef> out(len);
+        compress(out.data(), &len, reinterpret_cast<const Bytef*>(block.data()), block.size());
+        std::ofstream(dir + "/" + std::to_string(c), std::ios::binary)
+            .write(reinterpret_cast<const char*>(out.data()), static_cast<std::streamsize>(len));
+    }
+}
+
+void test_streaming_builder() {
+    Observations obs = synthetic_observations();
+    const size_t n = obs.nsr.size(), chunk = 700, missing = 3;  // 700 does not divide n
+    const std::string store = "test_streaming_store.zarr";
+
+    auto floats = [&](const std::vector<float>& v) {
+        std::vector<char> raw(n * sizeof(float));
+        std::memcpy(raw.data(), v.data(), raw.size());
+        return raw;
+    };
+    std::vector<char> stamps(n * 29, 0);
+    for (size_t i = 0; i < n; ++i)
+        if (obs.hours[i] != timeutil::kInvalidHour) {
+            const std::string ts = timeutil::format_hour(obs.hours[i]) + ":17:42.000000000";
+            std::memcpy(stamps.data() + i * 29, ts.data(), 29);
+        }
+
+    write_zarr_array(store + "/nsr", "<f4", 4, floats(obs.nsr), n, chunk, missing);
+    write_zarr_array(store + "/lat", "<f4", 4, floats(obs.lat), n, chunk, missing);
+    write_zarr_array(store + "/lon", "<f4", 4, floats(obs.lon), n, chunk, missing);
+    write_zarr_array(store + "/timestamps", "|S29", 29, stamps, n, chunk, missing);
+
+    // The missing chunk reads as zeros with invalid hours
+    for (size_t i = missing * chunk; i < (missing + 1) * chunk; ++i) {
+        obs.nsr[i] = obs.lat[i] = obs.lon[i] = 0.0f;
+        obs.hours[i] = timeutil::kInvalidHour;
+    }
+    const TimeAxis axis = TimeAxis::from_hours(obs.hours);
+    ValidityMask ref_valid;
+    auto ref = SimpleCubeBuilder::build(obs.lat, obs.lon, obs.nsr, obs.hours, axis, &ref_valid);
+
+    assert(StreamingCubeBuilder::scan_time_axis(store, 3) == axis);
+    for (unsigned int threads : {1u, 3u}) {
+        LoadStats stats;
+        ValidityMask valid;
+        auto cube = StreamingCubeBuilder::build(store, threads, &stats, &valid);
+        assert(same_cube(cube, ref));
+        assert(valid.count() == ref_valid.count());
+    }
+
+    std::filesystem::remove_all(store);
+    std::cout << "✓ test_streaming_builder passed\n";
+}
+
 int main() {
 
     test_basic_indexing();
     test_rollup_mean();
     test_global_mean();
     test_dice();
+    test_storage_layout();
+    test_tiled_cube();
+    test_pixel_major();
+    test_sparse_cube();
+    test_quantized_cube();
+    test_validity_mask();
+    test_prefix_sum_index();
+    test_thread_pool();
+    test_time_reduction();
+    test_reduce();
+    test_calendar_rollups();
+    test_measure_cube();
+    test_partial_cube();
+    test_cost_model();
+    test_cube_file();
+    test_epoch_hours();
+    test_time_axis();
+    test_parallel_builder_modes();
+    test_omp_builder_partitioning();
+    test_streaming_builder();
 
     std::cout << "\nAll tests passed.\n";
 